@@ -0,0 +1,67 @@
+#include <dawg-log/logger.hpp>
+#include <dawg-log/formatters/text_formatter.hpp>
+#include <dawg-log/sinks/sink.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <fmt/core.h>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace dog = DawgLog;
+
+namespace {
+/** Sink that only counts bytes, so the measurement covers the logger and formatter */
+class CountingSink : public dog::Sink {
+public:
+    void write(const dog::Record &, std::string_view formatted) override { bytes += formatted.size(); }
+
+    std::size_t bytes{0};
+};
+
+template<typename F>
+double ns_per_call(std::size_t iterations, F &&call) {
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        call(i);
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / static_cast<double>(iterations);
+}
+}
+
+int main(int argc, char **argv) {
+    const std::size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+
+    auto sink = std::make_unique<CountingSink>();
+    auto *dynamic_sink = sink.get();
+    std::vector<dog::Logger::Target> targets;
+    targets.push_back(dog::Logger::Target{std::move(sink), std::make_unique<dog::TextFormatter>()});
+    dog::Logger dynamic{std::move(targets), "bench"};
+
+    dog::StaticLogger<dog::Target<CountingSink, dog::TextFormatter>> fixed{"bench", CountingSink{}};
+
+    fmt::print("{} calls per case, text formatter, byte-counting sink\n", iterations);
+    fmt::print("{:<16}{:>12}{:>16}\n", "case", "Logger", "StaticLogger");
+
+    const double dynamic_written = ns_per_call(iterations, [&](std::size_t i) {
+        dynamic.log(dog::LogLevel::info, "bench", LOG_SRC, "request {} served in {} us", i, 42);
+    });
+    const double static_written = ns_per_call(iterations, [&](std::size_t i) {
+        fixed.log(dog::LogLevel::info, "bench", LOG_SRC, "request {} served in {} us", i, 42);
+    });
+    fmt::print("{:<16}{:>9.1f} ns{:>13.1f} ns\n", "written", dynamic_written, static_written);
+
+    dynamic.set_level(dog::LogLevel::warning);
+    fixed.set_level(dog::LogLevel::warning);
+    const double dynamic_dropped = ns_per_call(iterations, [&](std::size_t i) {
+        dynamic.log(dog::LogLevel::info, "bench", LOG_SRC, "request {} served in {} us", i, 42);
+    });
+    const double static_dropped = ns_per_call(iterations, [&](std::size_t i) {
+        fixed.log(dog::LogLevel::info, "bench", LOG_SRC, "request {} served in {} us", i, 42);
+    });
+    fmt::print("{:<16}{:>9.1f} ns{:>13.1f} ns\n", "below level", dynamic_dropped, static_dropped);
+
+    // Keep the sinks' work observable so it is not optimized away.
+    return dynamic_sink->bytes == fixed.target<0>().sink.bytes ? 0 : 1;
+}
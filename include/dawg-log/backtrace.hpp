@@ -0,0 +1,179 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <fmt/args.h>
+#include <fmt/core.h>
+#include "context.hpp"
+#include "lazy.hpp"
+#include "level.hpp"
+#include "record.hpp"
+#include "src_location.hpp"
+#include "trace_context.hpp"
+
+namespace DawgLog {
+    /**
+     * @brief Marks argument types that refer to data they do not own
+     *
+     * Captured records outlive the logging call, so messages with such arguments
+     * are formatted at capture instead. Covers fmt::join() results, standard range
+     * views and std::reference_wrapper; specialize it for other borrowing types.
+     */
+    template<typename T>
+    struct is_borrowed_arg : std::bool_constant<std::is_base_of_v<fmt::detail::view, T> || std::ranges::view<T>> {};
+
+    template<typename T>
+    struct is_borrowed_arg<std::reference_wrapper<T>> : std::true_type {};
+
+    namespace detail {
+        /**
+         * @brief Whether a captured record can keep an argument of type T unformatted
+         *
+         * String-like arguments are copied into owned strings and lazy() arguments are
+         * resolved first; anything else must be copy constructible, as
+         * fmt::dynamic_format_arg_store requires, and must not borrow its data (see
+         * is_borrowed_arg).
+         */
+        template<typename T>
+        constexpr bool capturable_arg() {
+            using V = std::remove_cvref_t<T>;
+            if constexpr (is_lazy_v<V>) {
+                return capturable_arg<typename V::value_type>();
+            } else if constexpr (std::is_convertible_v<const V &, std::string_view>) {
+                return true;
+            } else {
+                return std::is_copy_constructible_v<V> && !is_borrowed_arg<V>::value;
+            }
+        }
+    } // namespace detail
+
+    /**
+     * @brief A log call captured in binary form, without formatting its message
+     *
+     * Holds the format string and copies of the arguments, together with the time,
+     * thread and context of the original call. The message is only formatted if
+     * the record is later materialized.
+     *
+     * Capturing is cheaper than formatting but not free: the tag, the format string
+     * and string arguments are copied into owned strings, the argument store
+     * allocates, and the context is shared by reference count. Expect a few small
+     * heap allocations per captured call.
+     */
+    struct DeferredRecord {
+        LogLevel level{LogLevel::debug};
+        std::string tag;
+        SourceLocation src;
+        std::string format;
+        fmt::dynamic_format_arg_store<fmt::format_context> args;
+        std::chrono::system_clock::time_point time;
+        std::optional<std::chrono::nanoseconds> monotonic;
+        std::uint64_t thread_id{0};
+        SequenceMode seq_mode{SequenceMode::OFF};
+        std::uint64_t seq{0};
+        std::shared_ptr<const ContextFrame> context;
+        TraceContext trace;
+        std::optional<std::chrono::nanoseconds> duration;
+
+        /**
+         * @brief Capture a log call
+         *
+         * String-like arguments are copied into owned strings, other arguments are
+         * copied by value. lazy() arguments are resolved here, on the calling thread;
+         * lazy_owned() arguments are stored and only run if the record is materialized.
+         * If any argument cannot be copied (e.g. a move-only type) or borrows its data
+         * (e.g. fmt::join()), the message is formatted right away and stored instead.
+         */
+        template<typename... Args>
+        static DeferredRecord capture(LogLevel lvl, std::string_view tag, const SourceLocation &src,
+                                      fmt::string_view fmt_str, Args &&... args) {
+            DeferredRecord rec;
+            rec.level = lvl;
+            rec.tag = std::string(tag);
+            rec.src = src;
+            rec.time = clock_now();
+            if (monotonic_timestamps()) {
+                rec.monotonic = monotonic_now();
+            }
+            rec.thread_id = current_thread_id();
+            rec.seq_mode = sequence_mode();
+            rec.seq = next_sequence(rec.seq_mode);
+            rec.context = Context::current();
+            rec.trace = current_trace_context();
+            if constexpr ((detail::capturable_arg<Args>() && ...)) {
+                rec.format = std::string(fmt_str.data(), fmt_str.size());
+                (rec.push_arg(std::forward<Args>(args)), ...);
+            } else {
+                rec.format = "{}";
+                rec.args.push_back(fmt::vformat(fmt_str, fmt::make_format_args(args...)));
+            }
+            return rec;
+        }
+
+        /**
+         * @brief Format the message and build the full record
+         *
+         * @param app_name Application name to stamp on the record
+         * @param max_message_bytes Message bytes to keep, 0 for no limit
+         * @return Record The record as it would have looked when logged
+         */
+        [[nodiscard]] Record materialize(std::string_view app_name, std::size_t max_message_bytes = 0) const;
+
+    private:
+        template<typename T>
+        void push_arg(T &&arg) {
+            using V = std::remove_cv_t<std::remove_reference_t<T>>;
+            if constexpr (is_lazy_v<V>) {
+                push_arg(arg());
+            } else if constexpr (std::is_convertible_v<const V &, std::string_view>) {
+                args.push_back(std::string(std::string_view(arg)));
+            } else {
+                args.push_back(arg);
+            }
+        }
+    };
+
+    /**
+     * @brief Fixed-size ring of the most recent suppressed records
+     *
+     * Writers claim a slot with one atomic increment and never wait: if the slot is
+     * momentarily held by a concurrent drain or a writer that lapped the ring, the
+     * record is dropped. drain() returns the surviving records oldest first.
+     *
+     * The ring itself never allocates after construction, but the records stored in
+     * it do (see DeferredRecord), so a backtrace adds allocation work to every
+     * suppressed call.
+     */
+    class BacktraceBuffer {
+    public:
+        /** @param capacity Number of records kept */
+        explicit BacktraceBuffer(std::size_t capacity);
+
+        /** Store a record, overwriting the oldest one when full */
+        void push(DeferredRecord rec);
+
+        /** Remove and return all buffered records in logging order */
+        std::vector<DeferredRecord> drain();
+
+        /** @return std::size_t Number of records kept */
+        [[nodiscard]] std::size_t capacity() const { return capacity_; }
+
+    private:
+        struct Slot {
+            std::atomic_flag busy = ATOMIC_FLAG_INIT;
+            std::uint64_t seq{0};
+            std::optional<DeferredRecord> rec;
+        };
+
+        std::unique_ptr<Slot[]> slots_;
+        std::size_t capacity_;
+        std::atomic<std::uint64_t> head_{0};
+    };
+} // namespace DawgLog
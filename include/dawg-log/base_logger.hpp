@@ -1,12 +1,25 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <iterator>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <utility>
 #include <vector>
 #include <fmt/core.h>
+#include "backtrace.hpp"
 #include "config.hpp"
+#include "control_server.hpp"
+#include "filter.hpp"
+#include "metrics.hpp"
+#include "overload.hpp"
+#include "probes.hpp"
+#include "profiler.hpp"
+#include "request_scope.hpp"
 #include "sinks/sink.hpp"
+#include "stdio_capture.hpp"
 #include "formatters/formatter.hpp"
 #include "record.hpp"
 #include "src_location.hpp"
@@ -21,6 +34,8 @@ namespace DawgLog {
     * various severity levels.
     *
     * Logger instances are thread-safe and can be safely used from multiple threads.
+    * Log calls only share-lock the target list, so several threads may be inside
+    * the same sink or formatter at once; sinks serialize their own output.
     * The class follows a singleton pattern with the `instance()` method for accessing
     * the global logger instance.
     */
@@ -29,6 +44,12 @@ namespace DawgLog {
     struct Target {
         SinkPtr sink;
         FormatterPtr formatter;
+        /** Optional filter restricting which records reach this target */
+        Filter filter{};
+        /** Minimum level of records written to this target */
+        LogLevel level{LogLevel::debug};
+        /** Longer messages are truncated with a marker before formatting, 0 = no limit */
+        std::size_t max_record_bytes{0};
     };
     /**
      * @brief Construct a new Logger instance
@@ -54,6 +75,13 @@ namespace DawgLog {
      * The format string and arguments are processed to create the final log message,
      * which is then wrapped in a Record and passed to the configured sink.
      *
+     * Level, tag and call-site filters are evaluated before the message is
+     * formatted, so a rejected record never pays for fmt::format.
+     *
+     * Records below the logger's level are dropped, or captured unformatted into the
+     * backtrace buffer when one is enabled. An error or critical record first emits
+     * the buffered records.
+     *
      * @tparam Args Template parameters for variadic arguments
      * @param lvl The severity level of this log message
      * @param tag Optional tag for categorizing the log message
@@ -61,26 +89,121 @@ namespace DawgLog {
      * @param fmt_str Format string using fmt library syntax
      * @param args Arguments to be formatted into the message
      *
-     * @return formatted string (the message)
+     * When metrics are enabled the call is counted first, even if it is then dropped.
+     *
+     * Inside a RequestScope the record is captured unformatted and emitted, or
+     * discarded, when the scope ends.
+     *
+     * @return formatted string (the message), or an empty string when the record
+     *         was filtered out or deferred before formatting
      */
     template<typename... Args>
     std::string log(LogLevel lvl, std::string_view tag, const SourceLocation &src,
              fmt::string_view fmt_str, Args &&... args) {
-        std::lock_guard<std::mutex> lock(m_);
-        std::string msg;
+        DAWGLOG_PROBE3(log_entry, static_cast<int>(lvl), tag.data(), tag.size());
+        if (metrics_enabled_.load(std::memory_order_relaxed)) {
+            metrics_.record(lvl, tag, src);
+        }
+        std::shared_lock<std::shared_mutex> lock(m_);
+        if (lvl < base_threshold(tag, src)) {
+            DAWGLOG_PROBE1(level_reject, static_cast<int>(lvl));
+            if (backtrace_) {
+                backtrace_->push(DeferredRecord::capture(lvl, tag, src, fmt_str, std::forward<Args>(args)...));
+            }
+            return {};
+        }
+        // Records shed for overload are not worth capturing for a later backtrace.
+        if (lvl < overload_.floor()) {
+            DAWGLOG_PROBE1(level_reject, static_cast<int>(lvl));
+            relax_overload();
+            return {};
+        }
+        if (auto *request = RequestScope::current()) {
+            if (admits(lvl, tag, src)) {
+                request->capture(DeferredRecord::capture(lvl, tag, src, fmt_str, std::forward<Args>(args)...));
+            }
+            return {};
+        }
+        if (lvl >= LogLevel::error && backtrace_) {
+            dump_backtrace_locked();
+        }
+        if (!admits(lvl, tag, src)) {
+            return {};
+        }
+        const bool profiling = profiling_.load(std::memory_order_relaxed);
+        const std::uint64_t start = profiling ? read_cycles() : 0;
+        Record rec{lvl, tag, src, this->app_name_, {}};
+        rec.message = format_message(max_message_bytes_.load(std::memory_order_relaxed), fmt_str,
+                                     std::forward<Args>(args)...);
+        DAWGLOG_PROBE2(format_done, static_cast<int>(lvl), rec.message.size());
+        const std::size_t bytes = dispatch_observed(rec);
+        if (profiling) {
+            profile_site(src, bytes, read_cycles() - start);
+        }
+        return std::move(rec.message);
+    }
+
+    /**
+     * @brief Log the completion of a timing span
+     *
+     * Emits one record whose message is the span name and whose duration field
+     * carries the elapsed time; formatters render both.
+     *
+     * @param lvl The severity level of the record
+     * @param tag Tag for categorizing the record
+     * @param src Source location where the span was opened
+     * @param name Name of the span
+     * @param duration Time spent inside the span
+     */
+    void log_span(LogLevel lvl, std::string_view tag, const SourceLocation &src, std::string_view name,
+                  std::chrono::nanoseconds duration);
+
+    /**
+     * @brief Format a message using fmt library syntax
+     *
+     * @tparam Args Template parameters for variadic arguments
+     * @param fmt_str Format string using fmt library syntax
+     * @param args Arguments to be formatted into the message
+     * @return std::string The formatted message
+     */
+    template<typename... Args>
+    static std::string format_message(fmt::string_view fmt_str, Args &&... args) {
     #if FMT_VERSION >= 80000
-                 msg = fmt::format(fmt::runtime(fmt_str), std::forward<Args>(args)...);
+        return fmt::format(fmt::runtime(fmt_str), std::forward<Args>(args)...);
     #else
-        msg = fmt::format(fmt_str, std::forward<Args>(args)...);
+        return fmt::format(fmt_str, std::forward<Args>(args)...);
     #endif
-        auto rec = Record{lvl, tag, src, this->app_name_, msg};
-        for (auto &target : targets_) {
-            if (!target.sink || !target.formatter) {
-                continue;
-            }
-            target.sink->write(rec, target.formatter->format(rec));
+    }
+
+    /**
+     * @brief Format a message, keeping at most max_bytes of it
+     *
+     * Output past the limit is discarded while formatting instead of being built
+     * and cut afterwards; the result ends with a truncation marker (see
+     * truncate_message()). A limit of 0 formats the whole message.
+     *
+     * @param max_bytes Message bytes to keep, 0 for no limit
+     * @param fmt_str Format string using fmt library syntax
+     * @param args Arguments to be formatted into the message
+     * @return std::string The formatted, possibly truncated, message
+     */
+    template<typename... Args>
+    static std::string format_message(std::size_t max_bytes, fmt::string_view fmt_str, Args &&... args) {
+        if (max_bytes == 0) {
+            return format_message(fmt_str, std::forward<Args>(args)...);
         }
-        return msg;
+        std::string out;
+    #if FMT_VERSION >= 80000
+        const auto result = fmt::format_to_n(std::back_inserter(out), max_bytes, fmt::runtime(fmt_str),
+                                             std::forward<Args>(args)...);
+    #else
+        const auto result = fmt::format_to_n(std::back_inserter(out), max_bytes, fmt_str,
+                                             std::forward<Args>(args)...);
+    #endif
+        if (result.size <= max_bytes) {
+            return out;
+        }
+        return truncate_message(out, max_bytes, result.size);
     }
 
     /**
@@ -176,9 +299,287 @@ namespace DawgLog {
      */
     void add_target(SinkPtr sink, FormatterPtr formatter);
 
+    /**
+     * @brief Set the logger-wide filter
+     *
+     * Records rejected by this filter are dropped before reaching any target.
+     * Pass an empty Filter to accept everything.
+     *
+     * @param filter Compiled filter expression
+     */
+    void set_filter(Filter filter);
+
+    /**
+     * @brief Flush records buffered inside any target's sink
+     */
+    void flush();
+
+    /**
+     * @brief Set the minimum level of records that are emitted
+     *
+     * @param lvl Records below this level are dropped (or kept in the backtrace buffer)
+     */
+    void set_level(LogLevel lvl);
+
+    /** @return LogLevel The current minimum level */
+    [[nodiscard]] LogLevel level() const;
+
+    /**
+     * @brief Override the minimum level for one tag
+     *
+     * Takes precedence over the global level in both directions, so a single tag
+     * can be made more verbose than the rest.
+     *
+     * @param tag Tag to override
+     * @param lvl Minimum level for records with this tag
+     */
+    void set_tag_level(std::string_view tag, LogLevel lvl);
+
+    /** @brief Remove a tag's level override */
+    void clear_tag_level(std::string_view tag);
+
+    /**
+     * @brief Override the minimum level for one call site
+     *
+     * Takes precedence over tag and global levels.
+     *
+     * @param file Source file, matched against the end of LOG_SRC's file path
+     * @param line Line of the call, 0 for every call in the file
+     * @param lvl Minimum level for records from this site
+     */
+    void set_site_level(std::string_view file, int line, LogLevel lvl);
+
+    /** @brief Remove a call site's level override */
+    void clear_site_level(std::string_view file, int line);
+
+    /**
+     * @brief Set the minimum level written to one target
+     *
+     * @param index Position of the target, in configuration order
+     * @param lvl Minimum level for this target
+     * @return bool False if there is no such target
+     */
+    bool set_target_level(std::size_t index, LogLevel lvl);
+
+    /**
+     * @brief Reopen every target's sink, e.g. after log rotation
+     */
+    void reopen();
+
+    /**
+     * @brief Keep the last records below the active level for later diagnosis
+     *
+     * Suppressed records are captured unformatted into a ring of the given size. They
+     * are formatted and emitted, oldest first, just before the next error or critical
+     * record (including throw_error), or when dump_backtrace() is called.
+     *
+     * Capturing copies the arguments and runs lazy() callables of every suppressed
+     * call; see lazy_owned() to defer self-contained callables until the dump.
+     *
+     * @param capacity Number of records to keep; 0 disables the buffer
+     */
+    void enable_backtrace(std::size_t capacity);
+
+    /**
+     * @brief Emit and clear the records held in the backtrace buffer
+     */
+    void dump_backtrace();
+
+    /**
+     * @brief Format and emit records that were captured earlier
+     *
+     * Used by RequestScope when a buffered request turns out to be interesting.
+     *
+     * @param records Captured records in logging order
+     * @param dump_backtrace Emit the backtrace buffer first (the request failed)
+     */
+    void emit_deferred(std::vector<DeferredRecord> records, bool dump_backtrace);
+
+    /**
+     * @brief Set the sampling rules used by RequestScope objects created without options
+     * @param options Default request sampling options
+     */
+    void set_request_sampling(RequestSamplingOptions options);
+
+    /** @return RequestSamplingOptions The default request sampling options */
+    [[nodiscard]] RequestSamplingOptions request_sampling() const;
+
+    /**
+     * @brief Turn log-call counting on or off
+     *
+     * While enabled, every log call is counted by level, tag and call site before
+     * the level and filter checks. See Metrics.
+     *
+     * @param enabled True to count log calls
+     */
+    void enable_metrics(bool enabled);
+
+    /** @return const Metrics& Counters collected while metrics were enabled */
+    [[nodiscard]] const Metrics &metrics() const { return metrics_; }
+
+    /**
+     * @brief Periodically write the metrics to a file in Prometheus text format
+     *
+     * Also enables metrics. An empty path stops the writer.
+     *
+     * @param path File replaced with each snapshot
+     * @param interval Time between snapshots
+     */
+    void set_metrics_file(const std::string &path, std::chrono::milliseconds interval);
+
+    /**
+     * @brief Turn the call-site profiler on or off
+     *
+     * While on, each emitted record's formatting and sink time (in cycles) and the
+     * bytes its targets produced are attributed to its call site. When off, the log
+     * path pays one relaxed atomic load.
+     *
+     * @param enabled True to profile
+     */
+    void enable_profiling(bool enabled);
+
+    /** @return std::vector<SiteProfile> Profiled call sites, most expensive first */
+    [[nodiscard]] std::vector<SiteProfile> profile() const;
+
+    /**
+     * @brief Render the profile as a text table
+     * @param top Maximum number of sites to list, 0 for all
+     * @return std::string The report
+     */
+    [[nodiscard]] std::string profile_report(std::size_t top = 20) const;
+
+    /**
+     * @brief Execute one admin command and return its reply
+     *
+     * This is the command set served by the control socket:
+     * - `level [LEVEL]` show or set the global level
+     * - `level tag TAG LEVEL|reset`, `level site FILE[:LINE] LEVEL|reset`
+     * - `level target INDEX LEVEL`
+     * - `stats` metrics in Prometheus text format, plus the profile when it is on
+     * - `profile on|off|report`
+     * - `flush`, `rotate` (reopen sinks), `backtrace` (dump the backtrace buffer)
+     *
+     * @param command One command line
+     * @return std::string Reply, newline terminated; starts with "error:" on failure
+     */
+    std::string control(std::string_view command);
+
+    /**
+     * @brief Serve control() on a unix socket
+     *
+     * @param path Socket path; an empty path stops the server
+     * @return bool False if the socket could not be bound (the reason is printed)
+     */
+    bool set_control_socket(const std::string &path);
+
+    /**
+     * @brief Route everything written to stdout and stderr into this logger
+     *
+     * Lines written to fd 1 and 2 by any code become records with options.tag and
+     * options.level (options.stderr_level for stderr), logged from a reader thread.
+     * Console sinks keep writing to the real terminal. See StdioCapture.
+     *
+     * @param options Tag and levels; options.enabled = false restores stdout and stderr
+     * @return bool False if the capture could not be set up (the reason is printed)
+     */
+    bool set_stdio_capture(const StdioCaptureOptions &options);
+
+    /**
+     * @brief Configure automatic level escalation under sink pressure
+     *
+     * While the sinks are slow, records below a rising floor are dropped. See
+     * OverloadGuard. A warning record is emitted each time the floor changes.
+     *
+     * @param options Thresholds; options.enabled = false turns protection off
+     */
+    void set_overload_protection(const OverloadOptions &options);
+
+    /**
+     * @brief Cap the length of every formatted message
+     *
+     * Formatting stops writing at the cap and the message gets a truncation marker,
+     * so a huge argument is never copied in full. Individual targets can set a lower
+     * Target::max_record_bytes.
+     *
+     * @param max_bytes Message bytes to keep, 0 for no limit
+     */
+    void set_max_message_bytes(std::size_t max_bytes);
+
+    /** @return std::size_t The message cap, 0 when unlimited */
+    [[nodiscard]] std::size_t max_message_bytes() const;
+
+    /** @return LogLevel Level below which records are currently dropped for overload */
+    [[nodiscard]] LogLevel overload_floor() const { return overload_.floor(); }
+
    private:
+    /**
+     * Minimum level for a record, including tag and call-site overrides but not the
+     * overload floor, which callers check separately; caller holds m_
+     */
+    LogLevel base_threshold(std::string_view tag, const SourceLocation &src) const {
+        return has_level_overrides_ ? override_threshold(tag, src) : level_.load(std::memory_order_relaxed);
+    }
+
+    LogLevel override_threshold(std::string_view tag, const SourceLocation &src) const;
+
+    /** Pre-format check: can any target still accept a record with these fields? */
+    bool admits(LogLevel lvl, std::string_view tag, const SourceLocation &src) const;
+
+    /**
+     * Apply message-dependent filters and write the record to every accepting target
+     * @return std::size_t Total bytes produced by the targets' formatters
+     */
+    std::size_t dispatch(const Record &rec);
+
+    /** dispatch(), timed for overload protection when it is enabled */
+    std::size_t dispatch_observed(const Record &rec);
+
+    /** Let a record rejected by the overload floor lower it after a quiet cooldown; caller holds m_ */
+    void relax_overload();
+
+    /** Emit the warning that announces a new overload floor; caller holds m_ */
+    void report_overload();
+
+    /** Attribute one profiled record to its call site */
+    void profile_site(const SourceLocation &src, std::size_t bytes, std::uint64_t cycles);
+
+    /** Emit the backtrace buffer; caller holds m_ */
+    void dump_backtrace_locked();
+
+    /** Register the targets' descriptors for emergency() if this is the global logger; caller holds m_ */
+    void publish_emergency_fds_locked() const;
+
+    /** emergency_fds_generation() covered by the last publish_emergency_fds_locked() */
+    mutable std::atomic<std::uint64_t> emergency_generation_{0};
+
     std::vector<Target> targets_;
-    std::mutex m_;
+    mutable std::shared_mutex m_;
     std::string app_name_;
+    Filter filter_;
+    std::atomic<LogLevel> level_{LogLevel::debug};
+    std::atomic<std::size_t> max_message_bytes_{0};
+    std::unique_ptr<BacktraceBuffer> backtrace_;
+    RequestSamplingOptions request_sampling_;
+    std::atomic<bool> metrics_enabled_{false};
+    Metrics metrics_;
+    /** Declared after metrics_ so it stops, and writes its last snapshot, first */
+    std::unique_ptr<MetricsWriter> metrics_writer_;
+    std::atomic<bool> profiling_{false};
+    OverloadGuard overload_;
+
+    struct SiteLevel {
+        std::string file;
+        int line;
+        LogLevel level;
+    };
+    std::vector<std::pair<std::string, LogLevel>> tag_levels_;
+    std::vector<SiteLevel> site_levels_;
+    bool has_level_overrides_{false};
+
+    /** Like control_, stopped before the members its reader thread logs through */
+    std::unique_ptr<StdioCapture> capture_;
+
+    /** Declared last so its thread stops before anything it may touch is destroyed */
+    std::unique_ptr<ControlServer> control_;
    };
 } // namespace DawgLog
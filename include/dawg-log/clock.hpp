@@ -0,0 +1,69 @@
+#pragma once
+#include <chrono>
+#include <string>
+
+namespace DawgLog {
+    /**
+     * @brief Where record timestamps come from
+     *
+     * - REALTIME: clock_gettime(CLOCK_REALTIME), the default
+     * - REALTIME_COARSE: CLOCK_REALTIME_COARSE, a few ns per read but only tick-accurate (1-4 ms)
+     * - MONOTONIC: CLOCK_MONOTONIC mapped onto wall time once, so stamps never go backwards
+     * - TSC: the CPU time-stamp counter, converted to wall time by a calibration thread
+     */
+    enum class ClockSource {
+        REALTIME,
+        REALTIME_COARSE,
+        MONOTONIC,
+        TSC
+    };
+
+    /**
+     * @brief Select the clock used for new records, process-wide
+     *
+     * Selecting TSC measures the counter frequency (about 10 ms) and starts a thread
+     * that re-anchors the conversion every second. Where the TSC is missing or not
+     * invariant, MONOTONIC is used instead and a message is printed.
+     *
+     * @param source The clock to use
+     */
+    void set_clock_source(ClockSource source);
+
+    /** @return ClockSource The clock currently used for new records */
+    ClockSource clock_source();
+
+    /** @return std::chrono::system_clock::time_point Wall time read from the selected clock */
+    std::chrono::system_clock::time_point clock_now();
+
+    /**
+     * @brief Monotonic time since an unspecified epoch
+     *
+     * Read from the TSC when that is the selected clock, else from CLOCK_MONOTONIC.
+     * Recalibration only changes the TSC rate, never the value, so it does not step
+     * back; it converges on CLOCK_MONOTONIC over the following seconds.
+     *
+     * @return std::chrono::nanoseconds Monotonic time
+     */
+    std::chrono::nanoseconds monotonic_now();
+
+    /**
+     * @brief Also stamp records with monotonic_now()
+     *
+     * @param enabled True to fill Record::monotonic
+     */
+    void set_monotonic_timestamps(bool enabled);
+
+    /** @return bool True if records carry a monotonic timestamp */
+    bool monotonic_timestamps();
+
+    /**
+     * @brief Converts a string to a ClockSource enum value
+     *
+     * Accepts "realtime", "realtime_coarse", "monotonic" and "tsc". Unknown names
+     * print a message and fall back to REALTIME.
+     *
+     * @param name The clock name
+     * @return ClockSource The corresponding clock
+     */
+    ClockSource string_to_clock_source(const std::string &name);
+} // namespace DawgLog
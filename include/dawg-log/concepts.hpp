@@ -6,11 +6,26 @@
 
 #include <exception>
 #include <concepts>
+#include <string>
+#include <string_view>
 #include <type_traits>
+#include "record.hpp"
 
 namespace DawgLog {
 
 template <typename E>
 concept ExceptionType = std::is_base_of_v<std::exception, E>;
 
+/** Anything with Sink's write(const Record&, std::string_view) member */
+template <typename S>
+concept SinkLike = requires(S &s, const Record &r, std::string_view formatted) {
+    s.write(r, formatted);
+};
+
+/** Anything with Formatter's format(const Record&) member returning a string */
+template <typename F>
+concept FormatterLike = requires(F &f, const Record &r) {
+    { f.format(r) } -> std::convertible_to<std::string>;
+};
+
 }
@@ -1,10 +1,19 @@
 #pragma once
 #include "sinks/sink.hpp"
+#include "sinks/file_sink.hpp"
 #include "formatters/formatter.hpp"
+#include "clock.hpp"
+#include "filter.hpp"
+#include "overload.hpp"
+#include "request_scope.hpp"
+#include "sequence.hpp"
+#include "stdio_capture.hpp"
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <stdexcept>
 #include <vector>
 #include <nlohmann/json.hpp>
 
@@ -20,16 +29,61 @@ namespace DawgLog {
      * - Sink type (console, file, etc.)
      * - Formatter type (text, JSON, etc.)
      * - Application name for log identification
+     * - Filter expressions applied to the logger or to individual targets
      *
      * The class automatically handles file I/O errors and provides sensible defaults
      * when configuration values are missing or invalid.
      */
     class Config {
     public:
+        struct FallbackConfig {
+            SinkType sink{SinkType::CONSOLE};
+            std::string file_path{"dawglog.log"};
+        };
+        /**
+         * @brief One sink decorator from a "wrap" list
+         *
+         * Given either as a name or as an object with "type" and the decorator's
+         * parameters, e.g. {"type": "rate_limited", "per_second": 100}.
+         */
+        struct WrapConfig {
+            SinkWrapType type{SinkWrapType::BUFFERED};
+            /** LevelFilterSink minimum level ("level") */
+            LogLevel level{LogLevel::debug};
+            /** SampledSink keep fraction ("rate") */
+            double rate{1.0};
+            /** RateLimitedSink sustained rate and burst ("per_second", "burst") */
+            double per_second{1000.0};
+            std::uint32_t burst{0};
+            /** BufferedSink batch size ("bytes") */
+            std::size_t bytes{64 * 1024};
+            /** AsyncSink queue length and overflow policy ("capacity", "drop_when_full") */
+            std::size_t capacity{8192};
+            bool drop_when_full{false};
+        };
         struct TargetConfig {
             SinkType sink{SinkType::CONSOLE};
             FormatterType format{FormatterType::TEXT};
             std::string file_path{"dawglog.log"};
+            Filter filter;
+            /** Sinks tried in order when this target's sink fails ("fallbacks") */
+            std::vector<FallbackConfig> fallbacks;
+            /** Write latency that triggers a failover, 0 disables ("failover_latency_ms") */
+            std::uint32_t failover_latency_ms{0};
+            /** Interval between recovery probes of the primary sink ("probe_interval_ms") */
+            std::uint32_t probe_interval_ms{1000};
+            /**
+             * File sink tuning ("preallocate_bytes", "writeback_bytes", "drop_cache",
+             * "durable", "commit_max_wait_us", "commit_group_size", "direct_io",
+             * "direct_block_bytes")
+             */
+            FileSinkOptions file_options;
+            /** Decorators around the sink, outermost first ("wrap") */
+            std::vector<WrapConfig> wrap;
+            /** Longer messages are truncated before formatting, 0 = no limit ("max_record_bytes") */
+            std::size_t max_record_bytes{0};
+            /** Syslog records longer than this are split into continued messages ("syslog_chunk_bytes") */
+            std::size_t syslog_chunk_bytes{0};
         };
         /**
          * @brief Logger sink type enumeration
@@ -58,6 +112,97 @@ namespace DawgLog {
         std::string file_path;
         std::vector<TargetConfig> targets;
 
+        /**
+         * @brief Decorators around the single top-level sink ("wrap", outermost first)
+         */
+        std::vector<WrapConfig> wrap;
+
+        /**
+         * @brief Split syslog records of the top-level sink longer than this ("syslog_chunk_bytes", 0 = off)
+         */
+        std::size_t syslog_chunk_bytes{0};
+
+        /**
+         * @brief Cap on formatted message length, applied while formatting ("max_message_bytes", 0 = off)
+         */
+        std::size_t max_message_bytes{0};
+
+        /**
+         * @brief Logger-wide filter compiled from the "filter" key
+         *
+         * Records rejected by this filter are dropped before any target sees them.
+         * Each target may add its own filter through the same key.
+         */
+        Filter filter;
+
+        /**
+         * @brief Minimum level of emitted records ("level", default "debug")
+         */
+        LogLevel level{LogLevel::debug};
+
+        /**
+         * @brief Number of suppressed records kept for dumping on error ("backtrace", 0 = off)
+         */
+        std::size_t backtrace{0};
+
+        /**
+         * @brief Default RequestScope sampling rules ("request_sampling" object with
+         * "slow_threshold_ms", "sample_rate" and "max_records")
+         */
+        RequestSamplingOptions request_sampling;
+
+        /**
+         * @brief Count log calls by level, tag and call site ("metrics", default false)
+         */
+        bool metrics{false};
+
+        /**
+         * @brief Prometheus text file written periodically ("metrics_file"; implies "metrics")
+         */
+        std::string metrics_file;
+
+        /**
+         * @brief Interval between metrics file snapshots ("metrics_interval_ms", default 10000)
+         */
+        std::uint32_t metrics_interval_ms{10000};
+
+        /**
+         * @brief Start with the call-site profiler on ("profile", default false)
+         */
+        bool profile{false};
+
+        /**
+         * @brief Unix socket path for runtime admin commands ("control_socket", empty = off)
+         */
+        std::string control_socket;
+
+        /**
+         * @brief Automatic level escalation ("overload" object with "latency_high_us",
+         * "latency_low_us", "max_inflight" and "cooldown_ms"; present = enabled)
+         */
+        OverloadOptions overload;
+
+        /**
+         * @brief Timestamp source ("clock": "realtime", "realtime_coarse", "monotonic" or "tsc")
+         */
+        ClockSource clock{ClockSource::REALTIME};
+
+        /**
+         * @brief Also stamp records with a monotonic time ("monotonic_timestamps", default false)
+         */
+        bool monotonic_timestamps{false};
+
+        /**
+         * @brief Record numbering ("sequence": "off", "thread" or "global", default "off")
+         */
+        SequenceMode sequence{SequenceMode::OFF};
+
+        /**
+         * @brief Log what is written to stdout/stderr ("capture_stdio": true, or an object
+         * with "tag", "level" and "stderr_level")
+         */
+        StdioCaptureOptions capture_stdio;
+
         /**
          * @brief Construct a Config object from JSON file
          *
@@ -90,6 +235,49 @@ namespace DawgLog {
                 return path.lexically_normal().string();
             };
 
+            const auto compile_filter = [](const std::string &expr) {
+                try {
+                    return Filter::compile(expr);
+                } catch (const std::invalid_argument &e) {
+                    std::cerr << e.what() << ". Ignoring filter." << std::endl;
+                    return Filter{};
+                }
+            };
+
+            const auto parse_wrap = [](const nlohmann::json &node) {
+                std::vector<WrapConfig> out;
+                if (!node.is_array()) {
+                    return out;
+                }
+                for (const auto &item : node) {
+                    WrapConfig wrap;
+                    std::string name;
+                    if (item.is_string()) {
+                        name = item.get<std::string>();
+                    } else if (item.is_object()) {
+                        name = item.value("type", "");
+                        const std::string level_name = item.value("level", "debug");
+                        if (!parse_log_level(level_name, wrap.level)) {
+                            std::cerr << "Unknown log level '" << level_name << "'. Falling back to 'debug'." << std::endl;
+                        }
+                        wrap.rate = item.value("rate", wrap.rate);
+                        wrap.per_second = item.value("per_second", wrap.per_second);
+                        wrap.burst = item.value("burst", wrap.burst);
+                        wrap.bytes = item.value("bytes", wrap.bytes);
+                        wrap.capacity = item.value("capacity", wrap.capacity);
+                        wrap.drop_when_full = item.value("drop_when_full", wrap.drop_when_full);
+                    } else {
+                        continue;
+                    }
+                    if (!parse_sink_wrap_type(name, wrap.type)) {
+                        std::cerr << "Unknown sink decorator '" << name << "'. Ignoring it." << std::endl;
+                        continue;
+                    }
+                    out.emplace_back(wrap);
+                }
+                return out;
+            };
+
             std::ifstream file(json_path);
             if (!file.is_open()) {
                 std::cerr << "Failed to open logger config file: " << json_path << std::endl;
@@ -109,6 +297,65 @@ namespace DawgLog {
             format = string_to_formatter_type(j.value("format", "text"));
             app_name = j.value("app_name", "DawgLog");
             file_path = resolve_path(j.value("file_path", "dawglog.log"));
+            filter = compile_filter(j.value("filter", ""));
+            if (j.contains("wrap")) {
+                wrap = parse_wrap(j["wrap"]);
+            }
+            const std::string level_name = j.value("level", "debug");
+            if (!parse_log_level(level_name, level)) {
+                std::cerr << "Unknown log level '" << level_name << "'. Falling back to 'debug'." << std::endl;
+            }
+            backtrace = j.value("backtrace", std::size_t{0});
+            max_message_bytes = j.value("max_message_bytes", std::size_t{0});
+            syslog_chunk_bytes = j.value("syslog_chunk_bytes", std::size_t{0});
+            if (j.contains("request_sampling") && j["request_sampling"].is_object()) {
+                const auto &rs = j["request_sampling"];
+                request_sampling.slow_threshold = std::chrono::milliseconds{rs.value("slow_threshold_ms", 0)};
+                request_sampling.sample_rate = rs.value("sample_rate", 0.0);
+                request_sampling.max_records = rs.value("max_records", request_sampling.max_records);
+            }
+
+            metrics = j.value("metrics", false);
+            if (j.contains("metrics_file")) {
+                metrics_file = resolve_path(j.value("metrics_file", ""));
+            }
+            metrics_interval_ms = j.value("metrics_interval_ms", metrics_interval_ms);
+            profile = j.value("profile", false);
+            if (j.contains("control_socket")) {
+                control_socket = resolve_path(j.value("control_socket", ""));
+            }
+
+            clock = string_to_clock_source(j.value("clock", "realtime"));
+            monotonic_timestamps = j.value("monotonic_timestamps", false);
+            sequence = string_to_sequence_mode(j.value("sequence", "off"));
+            if (j.contains("capture_stdio")) {
+                const auto &cs = j["capture_stdio"];
+                if (cs.is_boolean()) {
+                    capture_stdio.enabled = cs.get<bool>();
+                } else if (cs.is_object()) {
+                    capture_stdio.enabled = cs.value("enabled", true);
+                    capture_stdio.tag = cs.value("tag", capture_stdio.tag);
+                    const std::string out_level = cs.value("level", "info");
+                    if (!parse_log_level(out_level, capture_stdio.level)) {
+                        std::cerr << "Unknown log level '" << out_level << "'. Falling back to 'info'." << std::endl;
+                    }
+                    const std::string err_level = cs.value("stderr_level", "warning");
+                    if (!parse_log_level(err_level, capture_stdio.stderr_level)) {
+                        std::cerr << "Unknown log level '" << err_level << "'. Falling back to 'warning'." << std::endl;
+                    }
+                }
+            }
+            if (j.contains("overload") && j["overload"].is_object()) {
+                const auto &ov = j["overload"];
+                overload.enabled = ov.value("enabled", true);
+                overload.latency_high = std::chrono::microseconds{
+                    ov.value("latency_high_us", static_cast<std::int64_t>(overload.latency_high.count()))};
+                overload.latency_low = std::chrono::microseconds{
+                    ov.value("latency_low_us", static_cast<std::int64_t>(overload.latency_high.count() / 4))};
+                overload.max_inflight = ov.value("max_inflight", overload.max_inflight);
+                overload.cooldown = std::chrono::milliseconds{
+                    ov.value("cooldown_ms", static_cast<std::int64_t>(overload.cooldown.count()))};
+            }
 
             if (j.contains("targets") && j["targets"].is_array()) {
                 for (const auto &target : j["targets"]) {
@@ -119,6 +366,38 @@ namespace DawgLog {
                     cfg.sink = string_to_sink_type(target.value("sink", "console"));
                     cfg.format = string_to_formatter_type(target.value("format", "text"));
                     cfg.file_path = resolve_path(target.value("file_path", "dawglog.log"));
+                    cfg.filter = compile_filter(target.value("filter", ""));
+                    if (target.contains("fallbacks") && target["fallbacks"].is_array()) {
+                        for (const auto &fallback : target["fallbacks"]) {
+                            FallbackConfig fb;
+                            if (fallback.is_string()) {
+                                fb.sink = string_to_sink_type(fallback.get<std::string>());
+                            } else if (fallback.is_object()) {
+                                fb.sink = string_to_sink_type(fallback.value("sink", "console"));
+                                fb.file_path = resolve_path(fallback.value("file_path", "dawglog.log"));
+                            } else {
+                                continue;
+                            }
+                            cfg.fallbacks.emplace_back(std::move(fb));
+                        }
+                    }
+                    cfg.failover_latency_ms = target.value("failover_latency_ms", 0U);
+                    cfg.probe_interval_ms = target.value("probe_interval_ms", 1000U);
+                    cfg.file_options.preallocate_bytes = target.value("preallocate_bytes", std::size_t{0});
+                    cfg.file_options.writeback_bytes = target.value("writeback_bytes", std::size_t{0});
+                    cfg.file_options.drop_cache = target.value("drop_cache", false);
+                    cfg.file_options.durable = target.value("durable", false);
+                    cfg.file_options.commit_max_wait =
+                            std::chrono::microseconds{target.value("commit_max_wait_us", 0)};
+                    cfg.file_options.commit_group_size = target.value("commit_group_size", std::size_t{0});
+                    cfg.file_options.direct_io = target.value("direct_io", false);
+                    cfg.file_options.direct_block_bytes =
+                            target.value("direct_block_bytes", cfg.file_options.direct_block_bytes);
+                    cfg.max_record_bytes = target.value("max_record_bytes", std::size_t{0});
+                    cfg.syslog_chunk_bytes = target.value("syslog_chunk_bytes", std::size_t{0});
+                    if (target.contains("wrap")) {
+                        cfg.wrap = parse_wrap(target["wrap"]);
+                    }
                     targets.emplace_back(std::move(cfg));
                 }
             }
@@ -0,0 +1,77 @@
+#pragma once
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <fmt/format.h>
+
+namespace DawgLog {
+    /**
+     * @brief One key/value pair pushed by a Context
+     *
+     * The value is rendered with fmt once, when the context is created.
+     */
+    struct ContextField {
+        template<typename T>
+        ContextField(std::string_view key, const T &value) : key(key), value(fmt::format("{}", value)) {
+        }
+
+        std::string_view key;
+        std::string value;
+    };
+
+    /**
+     * @brief Immutable, pre-encoded snapshot of a thread's context stack
+     *
+     * Records hold a reference to the frame that was current when they were
+     * created, so formatters only copy the pre-encoded bytes into their output.
+     */
+    struct ContextFrame {
+        /** Pairs rendered for text output: "request_id=42 user=bob" */
+        std::string text;
+
+        /** Pairs rendered as JSON object members: "\"request_id\":\"42\",\"user\":\"bob\"" */
+        std::string json;
+    };
+
+    /**
+     * @brief RAII diagnostic context (MDC) attached to every record of the thread
+     *
+     * Pushes key/value pairs onto a thread-local stack for the lifetime of the
+     * object. Nested contexts extend the enclosing one. The pairs are encoded for
+     * text and JSON output once, on construction.
+     *
+     * Usage example:
+     * ```cpp
+     * DawgLog::Context ctx{{"request_id", id}, {"user", user}};
+     * TAG_INFO(api, "handling request"); // ..., CONTEXT: request_id=42 user=bob, SOURCE: ...
+     * ```
+     *
+     * Contexts must be destroyed in the reverse order of creation, which scoping
+     * guarantees.
+     */
+    class Context {
+    public:
+        /**
+         * @brief Push the given pairs on top of the calling thread's context
+         * @param fields Key/value pairs to attach to records
+         */
+        Context(std::initializer_list<ContextField> fields);
+
+        /** Restore the context that was current before this one */
+        ~Context();
+
+        Context(const Context &) = delete;
+
+        Context &operator=(const Context &) = delete;
+
+        /**
+         * @brief Get the calling thread's current context frame
+         * @return std::shared_ptr<const ContextFrame> The frame, or null when no context is active
+         */
+        static std::shared_ptr<const ContextFrame> current();
+
+    private:
+        std::shared_ptr<const ContextFrame> previous_;
+    };
+} // namespace DawgLog
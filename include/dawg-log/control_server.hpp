@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <sys/types.h>
+
+namespace DawgLog {
+    /**
+     * @brief Line-oriented admin endpoint on a local unix socket
+     *
+     * Listens on a SOCK_STREAM unix socket from a small background thread and
+     * serves one client at a time. Each newline-terminated request is passed to the
+     * handler and its reply is written back. Use it with any line client:
+     *
+     * ```
+     * echo "level tag db debug" | socat - UNIX-CONNECT:/run/app/log.sock
+     * ```
+     *
+     * The socket is created with mode 0600, so only the owning user can connect.
+     * A client idle for 30 seconds, or one that stops reading replies, is
+     * disconnected. The socket file is removed when the server is destroyed,
+     * unless another server has bound the same path since.
+     */
+    class ControlServer {
+    public:
+        /** Maps a request line (without the newline) to its reply */
+        using Handler = std::function<std::string(std::string_view)>;
+
+        /**
+         * @brief Bind the socket and start serving
+         *
+         * An existing socket at path is replaced; any other kind of file is left alone.
+         *
+         * @param path Filesystem path of the socket
+         * @param handler Called on the server thread for every request line
+         * @throws std::system_error If the socket cannot be created or bound, or path
+         *         names a file that is not a socket
+         */
+        ControlServer(std::string path, Handler handler);
+
+        /** Stops the server thread and removes the socket file */
+        ~ControlServer();
+
+        ControlServer(const ControlServer &) = delete;
+
+        ControlServer &operator=(const ControlServer &) = delete;
+
+        /** @return const std::string& The socket path */
+        [[nodiscard]] const std::string &path() const { return path_; }
+
+    private:
+        void run();
+
+        void serve(int fd);
+
+        std::string path_;
+        Handler handler_;
+        int listen_fd_{-1};
+        dev_t dev_{0};
+        ino_t ino_{0};
+        std::atomic<bool> stop_{false};
+        std::thread thread_;
+    };
+} // namespace DawgLog
@@ -0,0 +1,92 @@
+#pragma once
+#include "src_location.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace DawgLog {
+    /**
+     * @brief Async-signal-safe logging for signal handlers and corrupted heaps
+     *
+     * emergency() renders one CRITICAL line into a stack buffer and write(2)s it to
+     * the file descriptors registered with set_emergency_fds() (stderr if none). It
+     * takes no locks, does not allocate and does not touch errno as seen by the
+     * caller. The message must be a string literal; an integer may be appended in
+     * decimal or, with emergency_hex(), in hex:
+     *
+     *     emergency(LOG_SRC, "caught SIGSEGV");
+     *     emergency(LOG_SRC, "signal", sig);
+     *     emergency_hex(LOG_SRC, "fault address", reinterpret_cast<std::uintptr_t>(addr));
+     *
+     * Logger::init registers the descriptors of its file and console sinks and the
+     * app name; other sinks (syslog, trace, O_DIRECT files) are skipped. Lines are
+     * shaped like TextFormatter output, with the local time computed from the UTC
+     * offset captured at registration.
+     *
+     * Registered descriptors are duplicated, so a sink closing its file can never
+     * leave emergency() writing to a reused descriptor number. A sink whose
+     * native_fd() changes (a FileSink reopening, a FailoverSink switching) calls
+     * emergency_fds_changed(), and the global logger re-registers its descriptors
+     * before writing its next record.
+     */
+
+    /** Maximum number of registered emergency descriptors */
+    inline constexpr std::size_t EMERGENCY_MAX_FDS = 8;
+
+    /**
+     * @brief Replace the descriptors emergency() writes to
+     *
+     * Not signal-safe itself; concurrent calls are serialized. Each descriptor is
+     * duplicated, and the copies from the registration before the previous one are
+     * closed, so a handler still using the previous set is not cut off. Duplicates
+     * and negative values are skipped, at most EMERGENCY_MAX_FDS are kept.
+     */
+    void set_emergency_fds(const int *fds, std::size_t count);
+
+    namespace detail {
+        inline std::atomic<std::uint64_t> emergency_fds_generation{0};
+    } // namespace detail
+
+    /** @brief Note that a sink's native_fd() changed, so loggers re-register their descriptors */
+    inline void emergency_fds_changed() {
+        detail::emergency_fds_generation.fetch_add(1, std::memory_order_release);
+    }
+
+    /** @return std::uint64_t Number of emergency_fds_changed() calls so far */
+    inline std::uint64_t emergency_fds_generation() {
+        return detail::emergency_fds_generation.load(std::memory_order_acquire);
+    }
+
+    /** @brief Pre-render the line header for app_name (not signal-safe) */
+    void set_emergency_app_name(std::string_view app_name);
+
+    namespace detail {
+        enum class EmergencyValue {
+            NONE,
+            DEC,
+            HEX
+        };
+
+        void emergency(const SourceLocation &src, const char *msg, std::size_t len,
+                       EmergencyValue kind, std::uint64_t value) noexcept;
+    } // namespace detail
+
+    /** @brief Log a literal message, async-signal-safe */
+    template<std::size_t N>
+    void emergency(const SourceLocation &src, const char (&msg)[N]) noexcept {
+        detail::emergency(src, msg, N - 1, detail::EmergencyValue::NONE, 0);
+    }
+
+    /** @brief Log a literal message followed by a signed decimal value, async-signal-safe */
+    template<std::size_t N>
+    void emergency(const SourceLocation &src, const char (&msg)[N], std::int64_t value) noexcept {
+        detail::emergency(src, msg, N - 1, detail::EmergencyValue::DEC, static_cast<std::uint64_t>(value));
+    }
+
+    /** @brief Log a literal message followed by a 0x-prefixed hex value, async-signal-safe */
+    template<std::size_t N>
+    void emergency_hex(const SourceLocation &src, const char (&msg)[N], std::uint64_t value) noexcept {
+        detail::emergency(src, msg, N - 1, detail::EmergencyValue::HEX, value);
+    }
+} // namespace DawgLog
@@ -0,0 +1,133 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "level.hpp"
+#include "record.hpp"
+#include "src_location.hpp"
+
+namespace DawgLog {
+    /**
+     * @brief Compiled filter expression deciding which records are emitted
+     *
+     * A Filter is compiled once from a small expression language into a flat
+     * postfix bytecode program and evaluated for every log call. Example:
+     *
+     * ```
+     * level >= warning && tag in {db, net} && !message_prefix("healthcheck")
+     * ```
+     *
+     * Supported predicates:
+     * - `level <op> NAME` and `line <op> NUMBER` with `==, !=, <, <=, >, >=`
+     * - `tag`, `file`, `func`, `message` compared with `==`, `!=` or `in {a, b}`
+     * - `<field>_prefix("...")` and `<field>_contains("...")` for the same fields
+     * - `true`, `false`, `!`, `&&`, `||` and parentheses
+     *
+     * Evaluation is split in two stages. Level, tag and call-site predicates are
+     * decided before the message is formatted; predicates on the message are only
+     * decided once it exists. A pre-format evaluation therefore yields REJECT,
+     * ACCEPT, or NEEDS_MESSAGE when the outcome depends on message content.
+     */
+    class Filter {
+    public:
+        /** Outcome of a pre-format evaluation */
+        enum class Result : std::uint8_t {
+            REJECT,
+            ACCEPT,
+            NEEDS_MESSAGE
+        };
+
+        /** Construct an empty filter that accepts every record */
+        Filter() = default;
+
+        /**
+         * @brief Compile a filter expression
+         *
+         * @param expr Expression source, see the class documentation for the grammar
+         * @return Filter The compiled filter (empty when expr is blank)
+         * @throws std::invalid_argument If the expression cannot be parsed
+         */
+        static Filter compile(std::string_view expr);
+
+        /**
+         * @brief Evaluate the filter before the message is formatted
+         *
+         * @param lvl Level of the pending record
+         * @param tag Tag of the pending record
+         * @param src Call site of the pending record
+         * @return Result REJECT or ACCEPT when decided, NEEDS_MESSAGE otherwise
+         */
+        [[nodiscard]] Result evaluate(LogLevel lvl, std::string_view tag, const SourceLocation &src) const;
+
+        /**
+         * @brief Evaluate the filter against a fully formatted record
+         *
+         * @param r The record to test
+         * @return bool True if the record passes the filter
+         */
+        [[nodiscard]] bool matches(const Record &r) const;
+
+        /** @return bool True if the filter has no program and accepts everything */
+        [[nodiscard]] bool empty() const { return code_.empty(); }
+
+        /** @return const std::string& The expression this filter was compiled from */
+        [[nodiscard]] const std::string &source() const { return source_; }
+
+    private:
+        friend class FilterCompiler;
+
+        /** Maximum evaluation stack depth accepted by the compiler */
+        static constexpr std::size_t MAX_DEPTH = 64;
+
+        /** Maximum nesting of '!' and parentheses accepted by the compiler */
+        static constexpr std::size_t MAX_NESTING = 256;
+
+        enum class Op : std::uint8_t {
+            PUSH_TRUE,
+            PUSH_FALSE,
+            LEVEL_CMP,
+            LINE_CMP,
+            STR_EQ,
+            STR_IN,
+            STR_PREFIX,
+            STR_CONTAINS,
+            NOT,
+            AND,
+            OR
+        };
+
+        enum class Field : std::uint8_t {
+            TAG,
+            FILE,
+            FUNC,
+            MESSAGE
+        };
+
+        enum class Cmp : std::uint8_t {
+            EQ,
+            NE,
+            LT,
+            LE,
+            GT,
+            GE
+        };
+
+        struct Instr {
+            Op op;
+            Field field;
+            Cmp cmp;
+            /** Operand: level, line number, or first index into strings_ */
+            std::int32_t arg;
+            /** Number of strings_ entries used by STR_IN */
+            std::uint32_t count;
+        };
+
+        std::uint8_t run(LogLevel lvl, std::string_view tag, const SourceLocation &src,
+                         const std::string_view *message) const;
+
+        std::vector<Instr> code_;
+        std::vector<std::string> strings_;
+        std::string source_;
+    };
+} // namespace DawgLog
@@ -32,6 +32,10 @@ namespace DawgLog {
          * a Record object into a formatted string. The format can vary depending on
          * the specific implementation (JSON, plain text, etc.).
          *
+         * @note Logger calls format() from every logging thread without serializing
+         *       the calls, so implementations must be safe to call concurrently
+         *       (e.g. keep no mutable state, or guard it).
+         *
          * @param r The log record to format
          * @return std::string Formatted string representation of the log record
          */
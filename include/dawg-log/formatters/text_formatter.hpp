@@ -14,6 +14,10 @@ namespace DawgLog {
          * The formatted output follows this pattern:
          * "APP_NAME TIMESTAMP [TAG] LEVEL: MESSAGE, SOURCE: FILE:LINE"
          *
+         * When a trace context is set, ", TRACE: TRACE_ID/SPAN_ID" is inserted before
+         * the source location, and so is ", CONTEXT: key=value ..." when a diagnostic
+         * Context is active.
+         *
          * Example output: "MyApp 14:30:45 [ERROR] ERROR: Database connection failed, SOURCE: main.cpp:42"
          *
          * @param r The Record object containing all log information to format
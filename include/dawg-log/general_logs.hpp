@@ -23,7 +23,8 @@ namespace DawgLog {
 
     template<ExceptionType E, typename... Args>
     static void throw_error(const SourceLocation& src, fmt::string_view fmt_str, Args&&... args) {
-        auto error_msg = Logger::instance().log(LogLevel::error, "General", src, fmt_str, std::forward<Args>(args)...);
+        auto error_msg = Logger::format_message(fmt_str, std::forward<Args>(args)...);
+        Logger::instance().log(LogLevel::error, "General", src, "{}", error_msg);
         throw E{error_msg};
     }
 
@@ -0,0 +1,103 @@
+#pragma once
+#include <type_traits>
+#include <utility>
+#include <fmt/core.h>
+
+namespace DawgLog {
+    /**
+     * @brief Log argument that is computed only when the message is formatted
+     *
+     * Wraps a callable whose result is formatted in place of the wrapper. Records
+     * rejected by the level, a sampling macro or a filter never call it.
+     *
+     * @warning Records captured for later formatting (the backtrace buffer and
+     * RequestScope) call it once on the logging thread at capture time, because the
+     * callable usually refers to locals that are gone by the time the record is
+     * emitted. With a backtrace enabled, a suppressed debug call therefore still
+     * pays for the callable on every call. Use lazy_owned() for callables that own
+     * their data to defer them until the record is actually formatted.
+     *
+     * Usage example:
+     * ```cpp
+     * TAG_DEBUG(ingest, "state {}", DawgLog::lazy([&] { return dump(state); }));
+     * ```
+     *
+     * @tparam F Callable taking no arguments and returning a formattable value
+     */
+    template<typename F>
+    class Lazy {
+    public:
+        using value_type = std::remove_cvref_t<std::invoke_result_t<const F &>>;
+
+        explicit Lazy(F f) : f_(std::move(f)) {}
+
+        /** @return value_type The computed argument */
+        value_type operator()() const { return f_(); }
+
+    private:
+        F f_;
+    };
+
+    /**
+     * @brief Wrap a callable as a lazily evaluated log argument
+     * @param f Callable taking no arguments
+     * @return Lazy<F> Wrapper accepted anywhere a format argument is
+     */
+    template<typename F>
+    Lazy<std::decay_t<F>> lazy(F &&f) {
+        return Lazy<std::decay_t<F>>(std::forward<F>(f));
+    }
+
+    /**
+     * @brief Lazy argument whose callable may outlive the logging call
+     *
+     * Unlike Lazy, captured records keep the callable itself and run it only if the
+     * record is formatted, possibly on another thread after the calling scope has
+     * ended. The callable must therefore own everything it uses (capture by value
+     * or shared_ptr, never by reference) and be copyable.
+     */
+    template<typename F>
+    class OwnedLazy : public Lazy<F> {
+    public:
+        using Lazy<F>::Lazy;
+    };
+
+    /**
+     * @brief Wrap a self-contained callable as a log argument deferred until formatting
+     *
+     * Usage example:
+     * ```cpp
+     * TAG_DEBUG(ingest, "state {}", DawgLog::lazy_owned([snapshot] { return dump(*snapshot); }));
+     * ```
+     *
+     * @param f Callable taking no arguments that captures nothing by reference
+     * @return OwnedLazy<F> Wrapper accepted anywhere a format argument is
+     */
+    template<typename F>
+    OwnedLazy<std::decay_t<F>> lazy_owned(F &&f) {
+        return OwnedLazy<std::decay_t<F>>(std::forward<F>(f));
+    }
+
+    template<typename T>
+    struct is_lazy : std::false_type {};
+
+    template<typename F>
+    struct is_lazy<Lazy<F>> : std::true_type {};
+
+    /** OwnedLazy is stored as-is by captured records instead of being resolved */
+    template<typename F>
+    struct is_lazy<OwnedLazy<F>> : std::false_type {};
+
+    template<typename T>
+    inline constexpr bool is_lazy_v = is_lazy<std::remove_cvref_t<T>>::value;
+} // namespace DawgLog
+
+template<typename F>
+struct fmt::formatter<DawgLog::Lazy<F>> : fmt::formatter<typename DawgLog::Lazy<F>::value_type> {
+    auto format(const DawgLog::Lazy<F> &v, fmt::format_context &ctx) const {
+        return fmt::formatter<typename DawgLog::Lazy<F>::value_type>::format(v(), ctx);
+    }
+};
+
+template<typename F>
+struct fmt::formatter<DawgLog::OwnedLazy<F>> : fmt::formatter<DawgLog::Lazy<F>> {};
@@ -1,4 +1,8 @@
 #pragma once
+#include <cctype>
+#include <cstddef>
+#include <string>
+#include <string_view>
 #include <syslog.h>
 
 namespace DawgLog {
@@ -35,6 +39,13 @@ X(critical, CRITICAL, "CRITICAL", LOG_CRIT)
 #undef X
     };
 
+    /** Number of LogLevel values */
+    inline constexpr std::size_t LOG_LEVEL_COUNT = 0
+#define X(name, general, str, syslog) + 1
+        LOG_LEVELS_XMACRO
+#undef X
+        ;
+
     /**
      * @brief Convert a LogLevel enum value to its string representation
      *
@@ -70,4 +81,37 @@ X(critical, CRITICAL, "CRITICAL", LOG_CRIT)
         }
         return LOG_INFO; // Default fallback
     }
+
+    /**
+     * @brief Parse a level name into its LogLevel enum value
+     *
+     * Accepts both the enum spelling ("warning") and the display string ("WARN"),
+     * compared case-insensitively.
+     *
+     * @param name The level name to parse
+     * @param out Receives the parsed level when the name is recognized
+     * @return bool True if the name was recognized
+     */
+    inline bool parse_log_level(std::string_view name, LogLevel &out) {
+        const auto iequals = [](std::string_view a, std::string_view b) {
+            if (a.size() != b.size()) {
+                return false;
+            }
+            for (std::size_t i = 0; i < a.size(); ++i) {
+                if (std::tolower(static_cast<unsigned char>(a[i])) !=
+                    std::tolower(static_cast<unsigned char>(b[i]))) {
+                    return false;
+                }
+            }
+            return true;
+        };
+#define X(lname, general, str, syslog) \
+        if (iequals(name, #lname) || iequals(name, str)) { \
+            out = LogLevel::lname; \
+            return true; \
+        }
+        LOG_LEVELS_XMACRO
+#undef X
+        return false;
+    }
 } // namespace DawgLog
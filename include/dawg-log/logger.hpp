@@ -3,3 +3,11 @@
 #include "tagged_logger.hpp"
 #include "general_logs.hpp"
 #include "config.hpp"
+#include "context.hpp"
+#include "emergency.hpp"
+#include "lazy.hpp"
+#include "request_scope.hpp"
+#include "sampling.hpp"
+#include "scope.hpp"
+#include "static_logger.hpp"
+#include "trace_context.hpp"
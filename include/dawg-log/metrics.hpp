@@ -0,0 +1,202 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "level.hpp"
+#include "src_location.hpp"
+
+namespace DawgLog {
+    /**
+     * @brief Fixed-size table of call sites, keyed by the LOG_SRC file pointer and line
+     *
+     * Lookups are lock-free; a new site claims an empty slot with one compare-and-swap.
+     * Sites are never removed, so a pointer returned by find() stays valid for the
+     * lifetime of the registry. When the table is full, new sites are not tracked.
+     */
+    class SiteRegistry {
+    public:
+        static constexpr std::size_t CAPACITY = 4096;
+
+        struct Site {
+            std::atomic<std::uint64_t> key{0};
+            std::atomic<bool> ready{false};
+            const char *file{""};
+            int line{0};
+            const char *func{""};
+            /** Metrics: slot + 1 of the first tag logged from this site, 0 when unset */
+            std::atomic<std::uint32_t> tag{0};
+            /** Profiler: records formatted and written while profiling was on */
+            std::atomic<std::uint64_t> profiled{0};
+            /** Profiler: bytes produced by all targets' formatters */
+            std::atomic<std::uint64_t> bytes{0};
+            /** Profiler: cycles spent formatting and in sinks */
+            std::atomic<std::uint64_t> cycles{0};
+        };
+
+        SiteRegistry();
+
+        /**
+         * @brief Find the entry for a call site, creating it on first use
+         * @param src Call site as produced by LOG_SRC
+         * @return Site* The entry, or nullptr when the table is full
+         */
+        Site *find(const SourceLocation &src);
+
+        /** @return std::size_t Position of a site returned by find(), below CAPACITY */
+        [[nodiscard]] std::size_t index(const Site &site) const {
+            return static_cast<std::size_t>(&site - sites_.get());
+        }
+
+        /** Call f(const Site&) for every registered site */
+        template<typename F>
+        void for_each(F &&f) const {
+            for (std::size_t i = 0; i < CAPACITY; ++i) {
+                if (sites_[i].ready.load(std::memory_order_acquire)) {
+                    f(sites_[i]);
+                }
+            }
+        }
+
+    private:
+        std::unique_ptr<Site[]> sites_;
+    };
+
+    /** Number of records logged from one call site */
+    struct SiteCount {
+        std::string file;
+        int line{0};
+        std::string func;
+        std::uint64_t count{0};
+    };
+
+    /**
+     * @brief Record counters derived from log calls
+     *
+     * Counts every log call by level, tag and call site before any level or filter
+     * check, so rates can be alerted on without parsing the output. Level, tag and
+     * site counters are sharded by thread so concurrent loggers do not contend on one
+     * cache line; the per-site and per-tag shards are allocated on the first record.
+     * A site remembers the tag it was first logged with, so the common case of a
+     * constant tag skips the tag hash and probe. Errors (error and critical) are also
+     * kept in one-second buckets covering the last WINDOW_SECONDS seconds.
+     */
+    class Metrics {
+    public:
+        static constexpr std::size_t SHARDS = 16;
+        static constexpr std::size_t MAX_TAGS = 512;
+        static constexpr std::size_t WINDOW_SECONDS = 60;
+
+        Metrics();
+
+        ~Metrics();
+
+        Metrics(const Metrics &) = delete;
+
+        Metrics &operator=(const Metrics &) = delete;
+
+        /** Count one log call */
+        void record(LogLevel lvl, std::string_view tag, const SourceLocation &src);
+
+        /** @return std::uint64_t Calls counted at the given level */
+        [[nodiscard]] std::uint64_t level_count(LogLevel lvl) const;
+
+        /** @return std::uint64_t Calls counted with the given tag */
+        [[nodiscard]] std::uint64_t tag_count(std::string_view tag) const;
+
+        /** @return std::vector<std::pair<std::string, std::uint64_t>> Count per tag */
+        [[nodiscard]] std::vector<std::pair<std::string, std::uint64_t>> tag_counts() const;
+
+        /** @return std::vector<SiteCount> Count per call site, highest first */
+        [[nodiscard]] std::vector<SiteCount> site_counts() const;
+
+        /**
+         * @brief Error and critical records per second
+         * @param window Period to average over, at most WINDOW_SECONDS
+         * @return double Average rate over the last window
+         */
+        [[nodiscard]] double error_rate(std::chrono::seconds window) const;
+
+        /** @return std::string All counters in the Prometheus text exposition format */
+        [[nodiscard]] std::string prometheus() const;
+
+        /** @return SiteRegistry& The call-site table shared with other per-site statistics */
+        SiteRegistry &sites() { return sites_; }
+
+        /** @return const SiteRegistry& The call-site table */
+        [[nodiscard]] const SiteRegistry &sites() const { return sites_; }
+
+    private:
+        struct alignas(64) Shard {
+            std::array<std::atomic<std::uint64_t>, LOG_LEVEL_COUNT> levels{};
+        };
+
+        struct alignas(64) ShardCounts {
+            std::array<std::atomic<std::uint64_t>, SiteRegistry::CAPACITY> sites{};
+            std::array<std::atomic<std::uint64_t>, MAX_TAGS> tags{};
+        };
+
+        struct Tag {
+            std::atomic<std::uint64_t> key{0};
+            std::atomic<bool> ready{false};
+            std::string name;
+        };
+
+        /** @return std::size_t Slot of the tag, created on first use, or MAX_TAGS when full */
+        std::size_t find_tag(std::string_view tag);
+
+        /** @return ShardCounts* The SHARDS per-thread site and tag counters, allocated on first use */
+        ShardCounts *counts();
+
+        /** @return std::uint64_t Sum of a tag slot over all shards */
+        [[nodiscard]] std::uint64_t tag_total(std::size_t slot) const;
+
+        std::array<Shard, SHARDS> shards_;
+        std::atomic<ShardCounts *> counts_{nullptr};
+        std::unique_ptr<Tag[]> tags_;
+        /** Per second: (steady second + 1) in the high 32 bits, error count in the low 32 */
+        std::array<std::atomic<std::uint64_t>, WINDOW_SECONDS> errors_{};
+        SiteRegistry sites_;
+    };
+
+    /**
+     * @brief Periodically writes Metrics::prometheus() to a file
+     *
+     * The file is replaced atomically (written to "<path>.tmp", then renamed), so a
+     * scraper such as the node_exporter textfile collector never reads a partial file.
+     * A final snapshot is written when the writer is destroyed.
+     */
+    class MetricsWriter {
+    public:
+        MetricsWriter(const Metrics &metrics, std::string path, std::chrono::milliseconds interval);
+
+        ~MetricsWriter();
+
+        MetricsWriter(const MetricsWriter &) = delete;
+
+        MetricsWriter &operator=(const MetricsWriter &) = delete;
+
+        /** Write a snapshot now */
+        void write() const;
+
+    private:
+        void run();
+
+        const Metrics &metrics_;
+        std::string path_;
+        std::chrono::milliseconds interval_;
+        std::mutex m_;
+        std::condition_variable cv_;
+        bool stop_{false};
+        std::thread thread_;
+    };
+} // namespace DawgLog
@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "level.hpp"
+
+namespace DawgLog {
+    /**
+     * @brief Thresholds for automatic level escalation
+     *
+     * Pressure is judged from a moving average of the time records spend in the
+     * sinks, and optionally from how many threads are writing at once.
+     */
+    struct OverloadOptions {
+        /** Turn overload protection on */
+        bool enabled{false};
+
+        /** Average sink latency above which the level is raised one step */
+        std::chrono::microseconds latency_high{1000};
+
+        /** Average sink latency below which the level is lowered one step */
+        std::chrono::microseconds latency_low{250};
+
+        /** Concurrent writers above which the level is raised (0 ignores concurrency) */
+        std::uint32_t max_inflight{0};
+
+        /** Minimum time between two level changes */
+        std::chrono::milliseconds cooldown{1000};
+    };
+
+    /**
+     * @brief Raises the logger's effective minimum level while sinks fall behind
+     *
+     * Each observed write updates an exponential moving average of sink latency.
+     * While it stays above latency_high, the floor is raised one level per cooldown
+     * period, up to error, so error and critical records are always written. Once
+     * the average drops below latency_low, the floor steps back down at the same
+     * pace. The gap between the two thresholds and the cooldown provide hysteresis.
+     *
+     * Only written records are timed, so a raised floor can block every record that
+     * would show the sinks have recovered. relax() covers that case: records rejected
+     * by the floor lower it one step once a cooldown passes with no write observed.
+     */
+    class OverloadGuard {
+    public:
+        /** Replace the options and reset the floor; callers must exclude concurrent writes */
+        void configure(const OverloadOptions &options);
+
+        /** @return bool True if writes should be observed */
+        [[nodiscard]] bool enabled() const { return options_.enabled; }
+
+        /** @return LogLevel Records below this level are currently dropped */
+        [[nodiscard]] LogLevel floor() const { return floor_.load(std::memory_order_relaxed); }
+
+        /** @return std::chrono::microseconds Current moving average of sink latency */
+        [[nodiscard]] std::chrono::microseconds latency() const;
+
+        /** Note that a write is starting */
+        void begin() { inflight_.fetch_add(1, std::memory_order_relaxed); }
+
+        /**
+         * @brief Note that a write finished and re-evaluate the floor
+         *
+         * @param elapsed Time spent writing the record to all targets
+         * @return bool True if this call changed the floor
+         */
+        bool end(std::chrono::nanoseconds elapsed);
+
+        /**
+         * @brief Lower the floor one step if no write has been observed for a cooldown
+         *
+         * Called for records the floor rejected. The stale latency average is cleared,
+         * so the sinks are judged afresh by the writes that follow.
+         *
+         * @return bool True if this call changed the floor
+         */
+        bool relax();
+
+        /** @return std::uint32_t Writers in flight when the floor last changed */
+        [[nodiscard]] std::uint32_t inflight_at_change() const {
+            return inflight_at_change_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        OverloadOptions options_;
+        std::atomic<LogLevel> floor_{LogLevel::debug};
+        std::atomic<std::uint32_t> inflight_{0};
+        std::atomic<std::uint32_t> inflight_at_change_{0};
+        std::atomic<std::int64_t> average_ns_{0};
+        std::atomic<std::int64_t> last_change_ns_{0};
+        std::atomic<std::int64_t> last_sample_ns_{0};
+    };
+} // namespace DawgLog
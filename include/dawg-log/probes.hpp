@@ -0,0 +1,35 @@
+#pragma once
+
+/**
+ * @file probes.hpp
+ * @brief Optional USDT probes marking the stages of a log call
+ *
+ * Built with the CMake option DAWGLOG_ENABLE_USDT (and sys/sdt.h available), each
+ * probe compiles to a single NOP plus an ELF note that tracers such as bpftrace,
+ * perf or SystemTap can attach to at runtime. Otherwise the macros expand to
+ * nothing and their arguments are not evaluated.
+ *
+ * Probes, all under the "dawglog" provider:
+ * - log_entry(level, tag, tag_len)
+ * - level_reject(level)
+ * - format_done(level, message_len)
+ * - sink_write_begin(sink, level)
+ * - sink_write_end(sink, bytes)
+ * - enqueue(sink, queue_depth), dequeue(sink, queue_depth) for asynchronous sinks
+ *
+ * Example:
+ * ```
+ * bpftrace -e 'usdt:./app:dawglog:level_reject { @[arg0] = count(); }'
+ * ```
+ */
+
+#if defined(DAWGLOG_HAS_USDT)
+#include <sys/sdt.h>
+#define DAWGLOG_PROBE1(name, a) DTRACE_PROBE1(dawglog, name, a)
+#define DAWGLOG_PROBE2(name, a, b) DTRACE_PROBE2(dawglog, name, a, b)
+#define DAWGLOG_PROBE3(name, a, b, c) DTRACE_PROBE3(dawglog, name, a, b, c)
+#else
+#define DAWGLOG_PROBE1(name, a) ((void)0)
+#define DAWGLOG_PROBE2(name, a, b) ((void)0)
+#define DAWGLOG_PROBE3(name, a, b, c) ((void)0)
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "metrics.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace DawgLog {
+    /**
+     * @brief Read a cheap, monotonically increasing cycle counter
+     *
+     * Uses the time-stamp counter on x86 and the monotonic clock in nanoseconds
+     * elsewhere. Only differences between two readings are meaningful.
+     *
+     * @return std::uint64_t Counter value
+     */
+    inline std::uint64_t read_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    /** Cost attributed to one call site by the profiler */
+    struct SiteProfile {
+        std::string file;
+        int line{0};
+        std::string func;
+        std::uint64_t calls{0};
+        std::uint64_t bytes{0};
+        std::uint64_t cycles{0};
+    };
+
+    /**
+     * @brief Collect the profiled call sites, most expensive first
+     * @param sites The call-site table filled while profiling was on
+     * @return std::vector<SiteProfile> Sites with at least one profiled call, by cycles
+     */
+    std::vector<SiteProfile> collect_profile(const SiteRegistry &sites);
+
+    /**
+     * @brief Render a profile as a fixed-width text table
+     *
+     * Each row shows the site's share of all profiled cycles, its call count, bytes
+     * produced and average cycles per call.
+     *
+     * @param profile Sites as returned by collect_profile()
+     * @param top Maximum number of rows, 0 for all
+     * @return std::string The report
+     */
+    std::string format_profile(const std::vector<SiteProfile> &profile, std::size_t top = 20);
+} // namespace DawgLog
@@ -1,7 +1,15 @@
 #pragma once
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <memory>
 #include <string>
+#include "clock.hpp"
+#include "context.hpp"
 #include "level.hpp"
+#include "sequence.hpp"
 #include "src_location.hpp"
+#include "trace_context.hpp"
 #include "utils.hpp"
 
 namespace DawgLog {
@@ -14,6 +22,7 @@ namespace DawgLog {
      * - The actual log message content
      * - Source location information where the log was generated
      * - Thread ID for multithreaded applications
+     * - The diagnostic context (see Context) active on the creating thread
      *
      * Records are typically created by Logger instances and passed to Sinks for output.
      */
@@ -21,9 +30,24 @@ namespace DawgLog {
         /** Name of the application that generated this log record */
         std::string app_name;
 
+        /** Wall-clock time when the record was created, read from the selected ClockSource */
+        std::chrono::system_clock::time_point time;
+
+        /** Monotonic time when the record was created, if monotonic timestamps are enabled */
+        std::optional<std::chrono::nanoseconds> monotonic;
+
         /** formatted timestamp when the record was created */
         std::string timestamp;
 
+        /** OS thread id of the thread that created the record */
+        std::uint64_t thread_id{0};
+
+        /** Numbering that produced seq, fixed when the record was created */
+        SequenceMode seq_mode{SequenceMode::OFF};
+
+        /** Sequence number (see SequenceMode), 0 when numbering is off */
+        std::uint64_t seq{0};
+
         /** Log level indicating the severity of the message */
         LogLevel level{LogLevel::info};
 
@@ -36,6 +60,15 @@ namespace DawgLog {
         /** Source location information where the log was generated */
         SourceLocation src;
 
+        /** Elapsed time for records emitted by a timing span, empty otherwise */
+        std::optional<std::chrono::nanoseconds> duration;
+
+        /** Diagnostic context of the creating thread, null when none was active */
+        std::shared_ptr<const ContextFrame> context;
+
+        /** Trace and span ids of the creating thread, stored inline */
+        TraceContext trace;
+
         /**
          * @brief Construct a new Record instance
          *
@@ -50,11 +83,70 @@ namespace DawgLog {
          */
         Record(LogLevel lvl, std::string_view tag, const SourceLocation &src, std::string_view app_name,
                std::string_view msg) : app_name(app_name),
-                                       timestamp(make_timestamp()),
+                                       time(clock_now()),
+                                       monotonic(monotonic_timestamps()
+                                                     ? std::optional(monotonic_now())
+                                                     : std::nullopt),
+                                       timestamp(make_timestamp(time)),
+                                       thread_id(current_thread_id()),
+                                       seq_mode(sequence_mode()),
+                                       seq(next_sequence(seq_mode)),
                                        level(lvl),
                                        tag(tag),
                                        message(msg),
-                                       src(src) {
+                                       src(src),
+                                       context(Context::current()),
+                                       trace(current_trace_context()) {
+        }
+
+        /**
+         * @brief Rebuild a record from fields captured when it was logged
+         *
+         * Reads no clock, sequence counter or thread state, so materializing a
+         * captured record later does not consume a sequence number.
+         */
+        Record(LogLevel lvl, std::string_view tag, const SourceLocation &src, std::string_view app_name,
+               std::string msg, std::chrono::system_clock::time_point time,
+               std::optional<std::chrono::nanoseconds> monotonic, std::uint64_t thread_id, SequenceMode seq_mode,
+               std::uint64_t seq, std::shared_ptr<const ContextFrame> context, TraceContext trace)
+            : app_name(app_name),
+              time(time),
+              monotonic(monotonic),
+              timestamp(make_timestamp(time)),
+              thread_id(thread_id),
+              seq_mode(seq_mode),
+              seq(seq),
+              level(lvl),
+              tag(tag),
+              message(std::move(msg)),
+              src(src),
+              context(std::move(context)),
+              trace(trace) {
+        }
+
+        /**
+         * @brief Copy a record with a different message, e.g. a truncated one
+         *
+         * Every other field, including the time and sequence number, is taken from
+         * other without copying its message.
+         *
+         * @param other The record to copy
+         * @param msg The message of the copy
+         */
+        Record(const Record &other, std::string msg) : app_name(other.app_name),
+                                                        time(other.time),
+                                                        monotonic(other.monotonic),
+                                                        timestamp(other.timestamp),
+                                                        thread_id(other.thread_id),
+                                                        seq_mode(other.seq_mode),
+                                                        seq(other.seq),
+                                                        level(other.level),
+                                                        tag(other.tag),
+                                                        message(std::move(msg)),
+                                                        src(other.src),
+                                                        duration(other.duration),
+                                                        context(other.context),
+                                                        trace(other.trace) {
         }
     };
 } // namespace DawgLog
@@ -0,0 +1,92 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "backtrace.hpp"
+#include "context.hpp"
+#include "level.hpp"
+
+namespace DawgLog {
+    /**
+     * @brief Decides which request scopes are worth emitting
+     */
+    struct RequestSamplingOptions {
+        /** Emit requests that took at least this long (0 disables the duration rule) */
+        std::chrono::milliseconds slow_threshold{0};
+
+        /** Fraction of all requests emitted regardless of outcome */
+        double sample_rate{0.0};
+
+        /** Upper bound on records buffered per request; later ones are counted and dropped */
+        std::size_t max_records{1000};
+    };
+
+    /**
+     * @brief Tail-based sampling scope for one request
+     *
+     * While a RequestScope is alive on a thread, records logged by that thread (at or
+     * above the logger's level and passing its filters) are captured unformatted
+     * instead of being written. The scope also pushes a "request_id" Context entry.
+     *
+     * When the scope ends the buffered records are either discarded or formatted and
+     * emitted in order. They are emitted if an error or critical record was logged,
+     * if the request took longer than the slow threshold, if keep() was called, or
+     * if the request fell into the random sample chosen at construction. An error
+     * also flushes the logger's backtrace buffer.
+     *
+     * Usage example:
+     * ```cpp
+     * void handle(const Request& req) {
+     *     DawgLog::RequestScope scope{req.id};
+     *     TAG_INFO(api, "start");   // buffered
+     *     ...
+     * } // emitted only if the request failed, was slow, or was sampled
+     * ```
+     */
+    class RequestScope {
+    public:
+        /**
+         * @brief Open a scope using the logger's configured sampling options
+         * @param id Request identifier, attached to every record as "request_id"
+         */
+        explicit RequestScope(std::string id);
+
+        /**
+         * @brief Open a scope with explicit sampling options
+         * @param id Request identifier, attached to every record as "request_id"
+         * @param options Rules deciding whether the request is emitted
+         */
+        RequestScope(std::string id, RequestSamplingOptions options);
+
+        /** Emit or discard the buffered records */
+        ~RequestScope();
+
+        RequestScope(const RequestScope &) = delete;
+
+        RequestScope &operator=(const RequestScope &) = delete;
+
+        /** Force this request to be emitted when the scope ends */
+        void keep() { keep_ = true; }
+
+        /** @return const std::string& The request identifier */
+        [[nodiscard]] const std::string &id() const { return id_; }
+
+        /** @return RequestScope* The innermost scope on the calling thread, or null */
+        static RequestScope *current();
+
+        /** Buffer a record logged inside the scope (called by Logger) */
+        void capture(DeferredRecord rec);
+
+    private:
+        std::string id_;
+        RequestSamplingOptions options_;
+        Context context_;
+        RequestScope *previous_;
+        std::chrono::steady_clock::time_point start_;
+        std::vector<DeferredRecord> records_;
+        std::size_t dropped_{0};
+        bool error_{false};
+        bool keep_{false};
+    };
+} // namespace DawgLog
@@ -0,0 +1,158 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "general_logs.hpp"
+#include "tagged_logger.hpp"
+#include "utils.hpp"
+
+/**
+ * @file sampling.hpp
+ * @brief Per-call-site rate limiting for log statements in hot loops
+ *
+ * Every macro keeps its state in a function-local static at the call site, so two
+ * INFO_EVERY_N lines never share a counter. The wrapped statement sits inside the
+ * `if`, so a skipped call evaluates none of its arguments.
+ *
+ * Usage example:
+ * ```cpp
+ * for (const auto& pkt : packets) {
+ *     TAG_WARNING_EVERY_N(net, 1000, "dropped packet from {}", pkt.source());
+ *     DEBUG_SAMPLED(0.01, "queue depth {}", queue.size());
+ *     TAG_INFO_EVERY_MS(net, 500, "throughput {} pps", meter.rate());
+ * }
+ * ```
+ */
+
+/** Run stmt on the 1st, (n+1)th, (2n+1)th... pass through this call site */
+#define DAWGLOG_EVERY_N(n, stmt) \
+    do { \
+        static std::atomic<std::uint64_t> dawglog_site_count_{0}; \
+        if (::DawgLog::Sampling::every_n(dawglog_site_count_, (n))) { stmt; } \
+    } while (0)
+
+/** Run stmt on the first n passes through this call site only */
+#define DAWGLOG_FIRST_N(n, stmt) \
+    do { \
+        static std::atomic<std::uint64_t> dawglog_site_count_{0}; \
+        if (::DawgLog::Sampling::first_n(dawglog_site_count_, (n))) { stmt; } \
+    } while (0)
+
+/** Run stmt at most once per ms milliseconds from this call site */
+#define DAWGLOG_EVERY_MS(ms, stmt) \
+    do { \
+        static std::atomic<std::int64_t> dawglog_site_last_{::DawgLog::Sampling::NEVER}; \
+        if (::DawgLog::Sampling::every_ms(dawglog_site_last_, (ms))) { stmt; } \
+    } while (0)
+
+/** Run stmt with probability p (0..1), decided independently per call */
+#define DAWGLOG_SAMPLED(p, stmt) \
+    do { \
+        if (::DawgLog::random_chance(p)) { stmt; } \
+    } while (0)
+
+namespace DawgLog::Sampling {
+    /** Initial value of an EVERY_MS site: the first call always passes */
+    inline constexpr std::int64_t NEVER = INT64_MIN;
+
+    /**
+     * @brief Count one pass and decide whether it is an every-nth one
+     * @param counter Per-site pass counter
+     * @param n Period; 0 and 1 pass every call
+     * @return bool True on passes 0, n, 2n...
+     */
+    inline bool every_n(std::atomic<std::uint64_t> &counter, std::uint64_t n) {
+        const auto seen = counter.fetch_add(1, std::memory_order_relaxed);
+        return n <= 1 || seen % n == 0;
+    }
+
+    /**
+     * @brief Count one pass and decide whether it is among the first n
+     * @param counter Per-site pass counter
+     * @param n Number of passes to admit
+     * @return bool True for the first n passes
+     */
+    inline bool first_n(std::atomic<std::uint64_t> &counter, std::uint64_t n) {
+        // Stop counting once the limit is reached so the counter never wraps.
+        if (counter.load(std::memory_order_relaxed) >= n) {
+            return false;
+        }
+        return counter.fetch_add(1, std::memory_order_relaxed) < n;
+    }
+
+    /**
+     * @brief Decide whether at least ms milliseconds passed since the last admitted call
+     * @param last Monotonic time of the last admitted call in nanoseconds
+     * @param ms Minimum interval in milliseconds
+     * @return bool True if this call is admitted; exactly one racing thread wins
+     */
+    inline bool every_ms(std::atomic<std::int64_t> &last, std::int64_t ms) {
+        const std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        std::int64_t prev = last.load(std::memory_order_relaxed);
+        if (prev != NEVER && now - prev < ms * 1000000) {
+            return false;
+        }
+        return last.compare_exchange_strong(prev, now, std::memory_order_relaxed);
+    }
+} // namespace DawgLog::Sampling
+
+#define DEBUG_EVERY_N(n, ...) DAWGLOG_EVERY_N((n), DEBUG(__VA_ARGS__))
+#define DEBUG_FIRST_N(n, ...) DAWGLOG_FIRST_N((n), DEBUG(__VA_ARGS__))
+#define DEBUG_EVERY_MS(ms, ...) DAWGLOG_EVERY_MS((ms), DEBUG(__VA_ARGS__))
+#define DEBUG_SAMPLED(p, ...) DAWGLOG_SAMPLED((p), DEBUG(__VA_ARGS__))
+
+#define INFO_EVERY_N(n, ...) DAWGLOG_EVERY_N((n), INFO(__VA_ARGS__))
+#define INFO_FIRST_N(n, ...) DAWGLOG_FIRST_N((n), INFO(__VA_ARGS__))
+#define INFO_EVERY_MS(ms, ...) DAWGLOG_EVERY_MS((ms), INFO(__VA_ARGS__))
+#define INFO_SAMPLED(p, ...) DAWGLOG_SAMPLED((p), INFO(__VA_ARGS__))
+
+#define NOTICE_EVERY_N(n, ...) DAWGLOG_EVERY_N((n), NOTICE(__VA_ARGS__))
+#define NOTICE_FIRST_N(n, ...) DAWGLOG_FIRST_N((n), NOTICE(__VA_ARGS__))
+#define NOTICE_EVERY_MS(ms, ...) DAWGLOG_EVERY_MS((ms), NOTICE(__VA_ARGS__))
+#define NOTICE_SAMPLED(p, ...) DAWGLOG_SAMPLED((p), NOTICE(__VA_ARGS__))
+
+#define WARNING_EVERY_N(n, ...) DAWGLOG_EVERY_N((n), WARNING(__VA_ARGS__))
+#define WARNING_FIRST_N(n, ...) DAWGLOG_FIRST_N((n), WARNING(__VA_ARGS__))
+#define WARNING_EVERY_MS(ms, ...) DAWGLOG_EVERY_MS((ms), WARNING(__VA_ARGS__))
+#define WARNING_SAMPLED(p, ...) DAWGLOG_SAMPLED((p), WARNING(__VA_ARGS__))
+
+#define ERROR_EVERY_N(n, ...) DAWGLOG_EVERY_N((n), ERROR(__VA_ARGS__))
+#define ERROR_FIRST_N(n, ...) DAWGLOG_FIRST_N((n), ERROR(__VA_ARGS__))
+#define ERROR_EVERY_MS(ms, ...) DAWGLOG_EVERY_MS((ms), ERROR(__VA_ARGS__))
+#define ERROR_SAMPLED(p, ...) DAWGLOG_SAMPLED((p), ERROR(__VA_ARGS__))
+
+#define CRITICAL_EVERY_N(n, ...) DAWGLOG_EVERY_N((n), CRITICAL(__VA_ARGS__))
+#define CRITICAL_FIRST_N(n, ...) DAWGLOG_FIRST_N((n), CRITICAL(__VA_ARGS__))
+#define CRITICAL_EVERY_MS(ms, ...) DAWGLOG_EVERY_MS((ms), CRITICAL(__VA_ARGS__))
+#define CRITICAL_SAMPLED(p, ...) DAWGLOG_SAMPLED((p), CRITICAL(__VA_ARGS__))
+
+#define TAG_DEBUG_EVERY_N(logger, n, ...) DAWGLOG_EVERY_N((n), TAG_DEBUG(logger, __VA_ARGS__))
+#define TAG_DEBUG_FIRST_N(logger, n, ...) DAWGLOG_FIRST_N((n), TAG_DEBUG(logger, __VA_ARGS__))
+#define TAG_DEBUG_EVERY_MS(logger, ms, ...) DAWGLOG_EVERY_MS((ms), TAG_DEBUG(logger, __VA_ARGS__))
+#define TAG_DEBUG_SAMPLED(logger, p, ...) DAWGLOG_SAMPLED((p), TAG_DEBUG(logger, __VA_ARGS__))
+
+#define TAG_INFO_EVERY_N(logger, n, ...) DAWGLOG_EVERY_N((n), TAG_INFO(logger, __VA_ARGS__))
+#define TAG_INFO_FIRST_N(logger, n, ...) DAWGLOG_FIRST_N((n), TAG_INFO(logger, __VA_ARGS__))
+#define TAG_INFO_EVERY_MS(logger, ms, ...) DAWGLOG_EVERY_MS((ms), TAG_INFO(logger, __VA_ARGS__))
+#define TAG_INFO_SAMPLED(logger, p, ...) DAWGLOG_SAMPLED((p), TAG_INFO(logger, __VA_ARGS__))
+
+#define TAG_NOTICE_EVERY_N(logger, n, ...) DAWGLOG_EVERY_N((n), TAG_NOTICE(logger, __VA_ARGS__))
+#define TAG_NOTICE_FIRST_N(logger, n, ...) DAWGLOG_FIRST_N((n), TAG_NOTICE(logger, __VA_ARGS__))
+#define TAG_NOTICE_EVERY_MS(logger, ms, ...) DAWGLOG_EVERY_MS((ms), TAG_NOTICE(logger, __VA_ARGS__))
+#define TAG_NOTICE_SAMPLED(logger, p, ...) DAWGLOG_SAMPLED((p), TAG_NOTICE(logger, __VA_ARGS__))
+
+#define TAG_WARNING_EVERY_N(logger, n, ...) DAWGLOG_EVERY_N((n), TAG_WARNING(logger, __VA_ARGS__))
+#define TAG_WARNING_FIRST_N(logger, n, ...) DAWGLOG_FIRST_N((n), TAG_WARNING(logger, __VA_ARGS__))
+#define TAG_WARNING_EVERY_MS(logger, ms, ...) DAWGLOG_EVERY_MS((ms), TAG_WARNING(logger, __VA_ARGS__))
+#define TAG_WARNING_SAMPLED(logger, p, ...) DAWGLOG_SAMPLED((p), TAG_WARNING(logger, __VA_ARGS__))
+
+#define TAG_ERROR_EVERY_N(logger, n, ...) DAWGLOG_EVERY_N((n), TAG_ERROR(logger, __VA_ARGS__))
+#define TAG_ERROR_FIRST_N(logger, n, ...) DAWGLOG_FIRST_N((n), TAG_ERROR(logger, __VA_ARGS__))
+#define TAG_ERROR_EVERY_MS(logger, ms, ...) DAWGLOG_EVERY_MS((ms), TAG_ERROR(logger, __VA_ARGS__))
+#define TAG_ERROR_SAMPLED(logger, p, ...) DAWGLOG_SAMPLED((p), TAG_ERROR(logger, __VA_ARGS__))
+
+#define TAG_CRITICAL_EVERY_N(logger, n, ...) DAWGLOG_EVERY_N((n), TAG_CRITICAL(logger, __VA_ARGS__))
+#define TAG_CRITICAL_FIRST_N(logger, n, ...) DAWGLOG_FIRST_N((n), TAG_CRITICAL(logger, __VA_ARGS__))
+#define TAG_CRITICAL_EVERY_MS(logger, ms, ...) DAWGLOG_EVERY_MS((ms), TAG_CRITICAL(logger, __VA_ARGS__))
+#define TAG_CRITICAL_SAMPLED(logger, p, ...) DAWGLOG_SAMPLED((p), TAG_CRITICAL(logger, __VA_ARGS__))
@@ -0,0 +1,78 @@
+#pragma once
+#include <chrono>
+#include "base_logger.hpp"
+#include "level.hpp"
+#include "src_location.hpp"
+#include "tagged_logger.hpp"
+
+#define DAWGLOG_CONCAT_INNER(a, b) a##b
+#define DAWGLOG_CONCAT(a, b) DAWGLOG_CONCAT_INNER(a, b)
+
+/** Time the rest of the enclosing scope and log its duration on exit */
+#define DAWGLOG_SCOPE(logger, name) \
+    ::DawgLog::ScopedSpan DAWGLOG_CONCAT(dawglog_span_, __LINE__){(logger), (name), LOG_SRC}
+
+/** Like DAWGLOG_SCOPE, but only log when the scope took longer than threshold */
+#define DAWGLOG_SCOPE_OVER(logger, name, threshold) \
+    ::DawgLog::ScopedSpan DAWGLOG_CONCAT(dawglog_span_, __LINE__){(logger), (name), LOG_SRC, (threshold)}
+
+namespace DawgLog {
+    /**
+     * @brief RAII timing span that logs one record with its duration on exit
+     *
+     * The span reads the monotonic clock on entry and on exit. When a threshold is
+     * set and the span finished faster, nothing else happens, so a fast span costs
+     * two clock reads.
+     *
+     * Usage example:
+     * ```cpp
+     * TaggedLogger db("db");
+     * {
+     *     DAWGLOG_SCOPE_OVER(db, "query", std::chrono::milliseconds{5});
+     *     run_query();
+     * } // logs "query took 7.412 ms" if the query was slow
+     * ```
+     */
+    class ScopedSpan {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        /**
+         * @brief Open a span
+         *
+         * @param logger Tagged logger that receives the span record
+         * @param name Span name; must outlive the span (string literals do)
+         * @param src Source location of the span
+         * @param threshold Minimum duration worth logging (zero logs every span)
+         * @param lvl Level of the emitted record
+         */
+        ScopedSpan(const TaggedLogger &logger, const char *name, const SourceLocation &src,
+                   std::chrono::nanoseconds threshold = std::chrono::nanoseconds::zero(),
+                   LogLevel lvl = LogLevel::info)
+            : logger_(logger), name_(name), src_(src), threshold_(threshold), level_(lvl),
+              start_(clock::now()) {
+        }
+
+        ScopedSpan(const ScopedSpan &) = delete;
+
+        ScopedSpan &operator=(const ScopedSpan &) = delete;
+
+        /** Closes the span and logs it if it exceeded the threshold */
+        ~ScopedSpan() {
+            const auto elapsed = clock::now() - start_;
+            if (elapsed < threshold_) {
+                return;
+            }
+            Logger::instance().log_span(level_, logger_.tag(), src_, name_,
+                                        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+        }
+
+    private:
+        const TaggedLogger &logger_;
+        const char *name_;
+        SourceLocation src_;
+        std::chrono::nanoseconds threshold_;
+        LogLevel level_;
+        clock::time_point start_;
+    };
+} // namespace DawgLog
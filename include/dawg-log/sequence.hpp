@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace DawgLog {
+    /**
+     * @brief How records are numbered
+     *
+     * - OFF: records carry no sequence number
+     * - THREAD: a plain per-thread counter; (thread_id, seq) orders the records of each
+     *   thread exactly, at no cross-thread cost
+     * - GLOBAL: one shared atomic counter giving a total order across all threads
+     */
+    enum class SequenceMode {
+        OFF,
+        THREAD,
+        GLOBAL
+    };
+
+    /** Select the numbering of new records, process-wide */
+    void set_sequence_mode(SequenceMode mode);
+
+    /** @return SequenceMode The numbering of new records */
+    SequenceMode sequence_mode();
+
+    /**
+     * @brief Number a new record
+     * @return std::uint64_t The next number (starting at 1), or 0 when numbering is off
+     */
+    std::uint64_t next_sequence();
+
+    /**
+     * @brief Number a new record under a mode read once by the caller
+     * @param mode Numbering to apply, normally the result of sequence_mode()
+     * @return std::uint64_t The next number (starting at 1), or 0 for OFF
+     */
+    std::uint64_t next_sequence(SequenceMode mode);
+
+    /**
+     * @brief Converts a string to a SequenceMode enum value
+     *
+     * Accepts "off", "thread" and "global". Unknown names print a message and fall
+     * back to OFF.
+     *
+     * @param name The mode name
+     * @return SequenceMode The corresponding mode
+     */
+    SequenceMode string_to_sequence_mode(const std::string &name);
+} // namespace DawgLog
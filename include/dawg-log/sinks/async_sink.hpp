@@ -0,0 +1,70 @@
+#pragma once
+#include "sink.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace DawgLog {
+    /**
+     * @brief Decorator that writes to the wrapped sink from its own thread
+     *
+     * write() copies the record and its formatted text into a bounded queue and
+     * returns; a worker thread drains the queue in batches and calls the wrapped
+     * sink, then flushes it whenever the queue runs empty. When the queue is full,
+     * write() either waits for room or, with drop_when_full, discards the record
+     * and counts it in dropped().
+     */
+    class AsyncSink : public Sink {
+    public:
+        /**
+         * @param inner The sink written from the worker thread
+         * @param capacity Maximum queued records
+         * @param drop_when_full Drop instead of waiting when the queue is full
+         */
+        explicit AsyncSink(SinkPtr inner, std::size_t capacity = 8192, bool drop_when_full = false);
+
+        /** Drains the queue and stops the worker */
+        ~AsyncSink() override;
+
+        void write(const Record &r, std::string_view formatted) override;
+
+        /** Wait until every queued record was written, then flush the wrapped sink */
+        void flush() override;
+
+        [[nodiscard]] bool healthy() const override;
+
+        bool probe() override;
+
+        bool reopen() override;
+
+        [[nodiscard]] int native_fd() const override;
+
+        /** @return std::uint64_t Records discarded because the queue was full */
+        [[nodiscard]] std::uint64_t dropped() const;
+
+    private:
+        struct Item {
+            Record record;
+            std::string formatted;
+        };
+
+        void run();
+
+        SinkPtr inner_;
+        std::size_t capacity_;
+        bool drop_when_full_;
+        std::deque<Item> queue_;
+        std::uint64_t enqueued_{0};
+        std::uint64_t written_{0};
+        std::uint64_t dropped_{0};
+        bool stop_{false};
+        mutable std::mutex m_;
+        std::condition_variable work_cv_;
+        std::condition_variable done_cv_;
+        std::thread worker_;
+    };
+} // namespace DawgLog
@@ -0,0 +1,55 @@
+#pragma once
+#include "sink.hpp"
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace DawgLog {
+    /**
+     * @brief Decorator that batches records into fewer writes to the wrapped sink
+     *
+     * Formatted records below warning are queued together with their Record and
+     * handed to the wrapped sink's write_batch() once they add up to capacity bytes,
+     * so every record still arrives with its own level and message. FileSink and
+     * ConsoleSink join a batch into one system call; other sinks receive the records
+     * one by one. Records at warning or above flush the batch and are passed through
+     * at once.
+     *
+     * Buffered records are only written by flush() (e.g. Logger::flush()), by the
+     * destructor, or when wrapped in an AsyncSink, which flushes whenever its
+     * queue runs empty.
+     */
+    class BufferedSink : public Sink {
+    public:
+        /**
+         * @param inner The sink receiving batches
+         * @param capacity Buffered bytes that trigger a write
+         */
+        explicit BufferedSink(SinkPtr inner, std::size_t capacity = 64 * 1024);
+
+        /** Writes any buffered records */
+        ~BufferedSink() override;
+
+        void write(const Record &r, std::string_view formatted) override;
+
+        /** Write the buffered batch and flush the wrapped sink */
+        void flush() override;
+
+        [[nodiscard]] bool healthy() const override;
+
+        bool probe() override;
+
+        bool reopen() override;
+
+        [[nodiscard]] int native_fd() const override;
+
+    private:
+        void flush_locked();
+
+        SinkPtr inner_;
+        std::size_t capacity_;
+        std::vector<FormattedRecord> pending_;
+        std::size_t pending_bytes_{0};
+        std::mutex m_;
+    };
+} // namespace DawgLog
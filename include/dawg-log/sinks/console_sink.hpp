@@ -32,15 +32,23 @@ namespace DawgLog {
         /**
          * @brief Write a formatted log record to console
          *
-         * Writes the formatted log message to standard output in a thread-safe manner.
-         * The method acquires a mutex lock before writing to ensure that concurrent
-         * logging operations do not interleave output.
+         * Writes the formatted log message to standard output, or standard error for
+         * warnings and above, with one writev(2) under a mutex so that concurrent
+         * logging operations do not interleave output. While a StdioCapture is active
+         * the saved original descriptors are used, so records do not loop back into
+         * the capture.
          *
          * @param r The log record containing metadata about the log entry
          * @param formatted The pre-formatted string representation of the log message
          */
         void write(const Record &r, std::string_view formatted) override;
 
+        /** Join consecutive records bound for the same stream into one writev(2) */
+        void write_batch(std::span<const FormattedRecord> batch) override;
+
+        /** @return int stderr, where console sinks put severe records */
+        [[nodiscard]] int native_fd() const override;
+
     private:
         std::string app_name;
         std::mutex m_;
@@ -0,0 +1,91 @@
+#pragma once
+#include "sink.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DawgLog {
+    /**
+     * @brief Tuning knobs for FailoverSink
+     */
+    struct FailoverOptions {
+        /** A write slower than this moves traffic to the next sink (0 disables) */
+        std::chrono::milliseconds latency_threshold{0};
+
+        /** How often the background thread probes the primary while failed over */
+        std::chrono::milliseconds probe_interval{1000};
+    };
+
+    /**
+     * @brief Sink group with a primary and ordered fallbacks
+     *
+     * Records go to the first sink in the chain that is still healthy. When a write
+     * fails (the sink reports !healthy() afterwards) the same record is retried on
+     * the next sink, so a failover does not lose it. A write that succeeds but takes
+     * longer than the latency threshold keeps its record and moves later traffic to
+     * the next sink.
+     *
+     * Writes do not hold a group-wide lock, so a stalled sink only blocks the
+     * threads already inside it. While a write has been in progress for longer
+     * than the latency threshold, new records skip that sink and go to the next.
+     *
+     * While failed over, a background thread periodically calls probe() on the
+     * primary and switches back once it recovers.
+     */
+    class FailoverSink : public Sink {
+    public:
+        /**
+         * @brief Construct a failover group
+         *
+         * @param primary The preferred sink
+         * @param fallbacks Sinks to try in order when the previous one fails
+         * @param options Latency threshold and probe interval
+         */
+        FailoverSink(SinkPtr primary, std::vector<SinkPtr> fallbacks, FailoverOptions options);
+
+        /** Stops the probe thread */
+        ~FailoverSink() override;
+
+        void write(const Record &r, std::string_view formatted) override;
+
+        /** Flush every sink in the group */
+        void flush() override;
+
+        /** Reopen every sink in the group */
+        bool reopen() override;
+
+        /** @return int Descriptor of the sink currently receiving records */
+        [[nodiscard]] int native_fd() const override;
+
+        /** @return bool True if any sink in the group is healthy */
+        [[nodiscard]] bool healthy() const override;
+
+        /** @return std::size_t Index of the sink currently receiving records (0 = primary) */
+        [[nodiscard]] std::size_t active_index() const;
+
+    private:
+        void probe_loop();
+
+        /** True while a write to sink index has been running longer than the latency threshold */
+        [[nodiscard]] bool stalled(std::size_t index) const;
+
+        /** Move traffic from sink index to the next one, once */
+        void fail_over(std::size_t index, const char *reason);
+
+        std::vector<SinkPtr> sinks_;
+        FailoverOptions options_;
+        std::atomic<std::size_t> active_{0};
+        /** Per sink: steady_clock start of a write in progress, 0 when idle */
+        std::unique_ptr<std::atomic<std::int64_t>[]> busy_since_;
+
+        std::mutex probe_m_;
+        std::condition_variable probe_cv_;
+        bool stop_{false};
+        std::thread prober_;
+    };
+} // namespace DawgLog
@@ -1,24 +1,201 @@
 #pragma once
 #include "sink.hpp"
-#include <fstream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
 
 namespace DawgLog {
+    /**
+     * @brief Writeback tuning for FileSink
+     *
+     * All options are off by default. They only take effect on Linux.
+     */
+    struct FileSinkOptions {
+        /** Reserve disk space in chunks of this size with fallocate (0 disables) */
+        std::size_t preallocate_bytes{0};
+
+        /**
+         * Start writeback with sync_file_range every time this many bytes have been
+         * written, and wait for the previous window, bounding the dirty backlog (0 disables)
+         */
+        std::size_t writeback_bytes{0};
+
+        /** Drop written-back windows from the page cache with posix_fadvise(DONTNEED) */
+        bool drop_cache{false};
+
+        /**
+         * Block each write until its record is covered by an fdatasync. Concurrent
+         * writers share a single sync (group commit).
+         */
+        bool durable{false};
+
+        /** How long the commit leader waits for more records to join its group */
+        std::chrono::microseconds commit_max_wait{0};
+
+        /** Sync as soon as this many records are pending, without waiting further (0 disables) */
+        std::size_t commit_group_size{0};
+
+        /**
+         * Bypass the page cache with O_DIRECT. Records are collected in an aligned
+         * block and written once it is full; falls back to buffered writes when the
+         * filesystem rejects direct I/O.
+         */
+        bool direct_io{false};
+
+        /** Size of the aligned O_DIRECT block, rounded up to a multiple of 4 KiB */
+        std::size_t direct_block_bytes{64 * 1024};
+    };
+
+    /**
+     * @brief Group-commit, preallocation and writeback statistics for a FileSink
+     */
+    struct FileSinkStats {
+        /** Number of fdatasync calls issued */
+        std::uint64_t commits{0};
+        /** Number of records made durable by those calls */
+        std::uint64_t committed_records{0};
+        /** Largest number of records covered by a single commit */
+        std::uint64_t max_group_size{0};
+        /** Sum of the time spent in fdatasync */
+        std::chrono::nanoseconds total_commit_latency{0};
+        /** Slowest single fdatasync */
+        std::chrono::nanoseconds max_commit_latency{0};
+        /** Successful fallocate calls reserving preallocate_bytes chunks */
+        std::uint64_t preallocations{0};
+        /** Writeback windows submitted with sync_file_range */
+        std::uint64_t writeback_windows{0};
+    };
+
     /**
      * @brief File sink implementation for logging to a file
      *
      * The FileSink class writes formatted log records to a file in a thread-safe manner.
+     * Records are appended with a single write(2) per record. Write failures such as
+     * ENOSPC mark the sink unhealthy instead of being silently ignored; probe()
+     * reopens the file and re-checks free space.
+     *
+     * FileSinkOptions can preallocate the file in large chunks and keep the page
+     * cache's dirty backlog bounded so logging does not cause writeback storms.
+     *
+     * In durable mode write() returns only once the record has been flushed by an
+     * fdatasync. The first waiting writer becomes the commit leader, waits up to
+     * commit_max_wait for others to join, and issues one sync for the whole group.
+     *
+     * With direct_io the partial tail block is kept in memory and written padded,
+     * then truncated back to the real length, on flush(), on error records, and when
+     * the sink is destroyed.
      */
     class FileSink : public Sink {
     public:
-        explicit FileSink(std::string path);
+        explicit FileSink(std::string path, FileSinkOptions options = {});
+
+        ~FileSink() override;
 
         void write(const Record &r, std::string_view formatted) override;
 
+        /** Append the whole batch as one write, flushed like its most severe record */
+        void write_batch(std::span<const FormattedRecord> batch) override;
+
+        /** Write the partial O_DIRECT tail block, if any */
+        void flush() override;
+
+        [[nodiscard]] bool healthy() const override;
+
+        bool probe() override;
+
+        /** Close the file, releasing unused preallocated space, and open the path again */
+        bool reopen() override;
+
+        /** @return int The open file, or -1 while closed or writing with O_DIRECT */
+        [[nodiscard]] int native_fd() const override;
+
+        /** @return int errno of the last failed open or write, 0 if none */
+        [[nodiscard]] int last_error() const;
+
+        /** @return FileSinkStats Snapshot of the group-commit and writeback statistics */
+        [[nodiscard]] FileSinkStats stats() const;
+
     private:
+        bool open_locked();
+
+        void fail_locked(int err, const char *what);
+
+        /** Apply preallocation before writing len bytes */
+        void reserve_locked(std::size_t len);
+
+        /** Apply writeback and cache dropping after the offset advanced */
+        void writeback_locked();
+
+        /** Append through the page cache with writev */
+        bool write_buffered_locked(std::string_view formatted);
+
+        /** Plain write(2) of data through the page cache */
+        bool write_buffered_tail_locked(std::string_view data);
+
+        /** Copy into the aligned block, writing it out each time it fills up */
+        bool write_direct_locked(std::string_view data);
+
+        /** Write the first len bytes of the block at block_base_ with O_DIRECT */
+        bool write_block_locked(std::size_t len);
+
+        /** Write the partial tail block padded to alignment and trim the file */
+        bool flush_direct_locked();
+
+        /** Write pending direct I/O data and trim preallocated space before closing */
+        void release_locked();
+
+        /** Prepare the block buffer for a freshly opened O_DIRECT descriptor */
+        bool init_direct_locked();
+
+        /** Reopen without O_DIRECT and hand the block contents to buffered writes */
+        bool fall_back_to_buffered_locked();
+
+        /** Wait until record number ticket is covered by an fdatasync */
+        void commit_locked(std::unique_lock<std::mutex> &lock, std::uint64_t ticket);
+
         std::string path_;
-        std::ofstream out_;
-        std::mutex m_;
+        FileSinkOptions options_;
+        int fd_{-1};
+        /** Current end of file as seen by this sink */
+        std::uint64_t offset_{0};
+        /** End of the space reserved with fallocate */
+        std::uint64_t allocated_{0};
+        /** Start of the window whose writeback has been started but not waited on */
+        std::uint64_t flushing_from_{0};
+        /** Start of the window not yet submitted for writeback */
+        std::uint64_t dirty_from_{0};
+
+        struct AlignedFree {
+            void operator()(char *p) const;
+        };
+        /** O_DIRECT staging block, allocated on first use */
+        std::unique_ptr<char, AlignedFree> block_;
+        std::size_t block_size_{0};
+        /** File offset of the first byte in block_ (always aligned) */
+        std::uint64_t block_base_{0};
+        std::size_t block_fill_{0};
+        /** Leading bytes of block_ that are already in the file */
+        std::size_t block_synced_{0};
+        /** Staged bytes whose tail flush failed before a reopen, written to the new descriptor */
+        std::string carry_;
+        bool direct_{false};
+        int last_errno_{0};
+        std::atomic<bool> healthy_{false};
+        mutable std::mutex m_;
+
+        /** Records written so far, used as commit tickets */
+        std::uint64_t written_seq_{0};
+        /** Highest ticket covered by a completed fdatasync */
+        std::uint64_t synced_seq_{0};
+        /** Highest ticket whose fdatasync failed; its writers return with the sink unhealthy */
+        std::uint64_t failed_seq_{0};
+        bool committing_{false};
+        std::condition_variable commit_cv_;
+        FileSinkStats stats_;
     };
 } // namespace DawgLog
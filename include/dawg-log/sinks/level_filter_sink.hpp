@@ -0,0 +1,32 @@
+#pragma once
+#include "sink.hpp"
+
+namespace DawgLog {
+    /**
+     * @brief Decorator that forwards only records at or above a minimum level
+     */
+    class LevelFilterSink : public Sink {
+    public:
+        /**
+         * @param inner The sink receiving accepted records
+         * @param min_level Records below this level are discarded
+         */
+        LevelFilterSink(SinkPtr inner, LogLevel min_level);
+
+        void write(const Record &r, std::string_view formatted) override;
+
+        void flush() override;
+
+        [[nodiscard]] bool healthy() const override;
+
+        bool probe() override;
+
+        bool reopen() override;
+
+        [[nodiscard]] int native_fd() const override;
+
+    private:
+        SinkPtr inner_;
+        LogLevel min_level_;
+    };
+} // namespace DawgLog
@@ -0,0 +1,56 @@
+#pragma once
+#include "sink.hpp"
+#include "../formatters/formatter.hpp"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace DawgLog {
+    /**
+     * @brief Decorator that caps the record rate with a token bucket
+     *
+     * Up to burst records pass at once, refilled at per_second records per second.
+     * Records over the limit are dropped and counted. When the sink has a formatter,
+     * the next record that passes is preceded by a warning saying how many were
+     * suppressed, formatted like the target's other records; without one the count is
+     * only available from dropped().
+     */
+    class RateLimitedSink : public Sink {
+    public:
+        /**
+         * @param inner The sink receiving admitted records
+         * @param per_second Sustained records per second
+         * @param burst Records allowed at once, 0 means per_second
+         * @param formatter Formats the suppression warning, normally a second instance of
+         *                  the target's formatter; null writes no warning
+         */
+        RateLimitedSink(SinkPtr inner, double per_second, std::uint32_t burst = 0,
+                        FormatterPtr formatter = nullptr);
+
+        void write(const Record &r, std::string_view formatted) override;
+
+        void flush() override;
+
+        [[nodiscard]] bool healthy() const override;
+
+        bool probe() override;
+
+        bool reopen() override;
+
+        [[nodiscard]] int native_fd() const override;
+
+        /** @return std::uint64_t Records dropped since construction */
+        [[nodiscard]] std::uint64_t dropped() const;
+
+    private:
+        SinkPtr inner_;
+        FormatterPtr formatter_;
+        double per_second_;
+        double burst_;
+        double tokens_;
+        std::chrono::steady_clock::time_point last_;
+        std::uint64_t suppressed_{0};
+        std::uint64_t dropped_{0};
+        mutable std::mutex m_;
+    };
+} // namespace DawgLog
@@ -0,0 +1,35 @@
+#pragma once
+#include "sink.hpp"
+
+namespace DawgLog {
+    /**
+     * @brief Decorator that forwards a random fraction of records
+     *
+     * Records at error or above are always forwarded, so sampling a noisy sink
+     * never hides failures.
+     */
+    class SampledSink : public Sink {
+    public:
+        /**
+         * @param inner The sink receiving sampled records
+         * @param rate Fraction of records to keep, between 0 and 1
+         */
+        SampledSink(SinkPtr inner, double rate);
+
+        void write(const Record &r, std::string_view formatted) override;
+
+        void flush() override;
+
+        [[nodiscard]] bool healthy() const override;
+
+        bool probe() override;
+
+        bool reopen() override;
+
+        [[nodiscard]] int native_fd() const override;
+
+    private:
+        SinkPtr inner_;
+        double rate_;
+    };
+} // namespace DawgLog
@@ -1,9 +1,17 @@
 #pragma once
 #include "../record.hpp"
 #include <memory>
+#include <span>
+#include <string>
 #include <string_view>
 
 namespace DawgLog {
+    /** @brief A record together with its formatted text, as queued by decorators */
+    struct FormattedRecord {
+        Record record;
+        std::string text;
+    };
+
     /**
      * @brief Abstract base class for log sinks
      *
@@ -26,10 +34,74 @@ namespace DawgLog {
          * The implementation should handle writing the formatted string to the appropriate
          * output destination (file, console, network, etc.).
          *
+         * @note Logger calls write() from every logging thread without serializing
+         *       the calls, so implementations must synchronize themselves, as the
+         *       built-in sinks do.
+         *
          * @param r The original log record that was formatted
          * @param formatted The pre-formatted string representation of the log record
          */
         virtual void write(const Record &r, std::string_view formatted) = 0;
+
+        /**
+         * @brief Write several records, oldest first
+         *
+         * Called by BufferedSink when it replays a batch. The default writes each
+         * record on its own; line-oriented sinks override it to join the lines
+         * into a single system call.
+         *
+         * @param batch The records and their formatted text
+         */
+        virtual void write_batch(std::span<const FormattedRecord> batch) {
+            for (const auto &entry : batch) {
+                write(entry.record, entry.text);
+            }
+        }
+
+        /**
+         * @brief Report whether the last write reached its destination
+         *
+         * Sinks that can detect failures (closed file, ENOSPC, ...) override this so
+         * that wrappers such as FailoverSink can react. The default never fails.
+         *
+         * @return bool True if the sink is currently able to write
+         */
+        [[nodiscard]] virtual bool healthy() const { return true; }
+
+        /**
+         * @brief Try to recover a sink that reported itself unhealthy
+         *
+         * Called periodically from a background thread while the sink is failed over.
+         * Implementations may reopen files or re-check free space.
+         *
+         * @return bool True if the sink is usable again
+         */
+        virtual bool probe() { return healthy(); }
+
+        /**
+         * @brief Push any records buffered inside the sink to their destination
+         *
+         * Sinks that write every record immediately need not override this.
+         */
+        virtual void flush() {}
+
+        /**
+         * @brief Reopen the destination, e.g. after logrotate moved the file away
+         *
+         * Sinks without a reopenable destination need not override this.
+         *
+         * @return bool True if the sink is usable after reopening
+         */
+        virtual bool reopen() { return healthy(); }
+
+        /**
+         * @brief Descriptor that emergency() may write plain text lines to
+         *
+         * Only sinks whose destination accepts raw appended lines return one.
+         *
+         * @return int The descriptor, or -1 if the sink has none
+         */
+        [[nodiscard]] virtual int native_fd() const { return -1; }
     };
 
     /** Type alias for unique pointer to Sink */
@@ -1,5 +1,8 @@
 #pragma once
 #include "sink.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace DawgLog {
@@ -11,14 +14,19 @@ namespace DawgLog {
      * the source of log messages in the syslog.
      *
      * This sink is typically used on Unix-like systems where syslog is available.
+     *
+     * Syslog daemons cut messages at a size limit (8 KiB by default in rsyslog).
+     * With a chunk size set, longer records are split into several syslog messages,
+     * each prefixed with "[ID PART/TOTAL] " so that the pieces can be joined again.
      */
     class SyslogSink : public Sink {
     public:
         /**
          * @brief Construct a new SyslogSink with the specified application name
          * @param app_name The name to use as the application identifier in syslog
+         * @param chunk_bytes Split records longer than this into continued messages, 0 = never
          */
-        explicit SyslogSink(std::string app_name);
+        explicit SyslogSink(std::string app_name, std::size_t chunk_bytes = 0);
 
         /**
          * @brief Destroy the SyslogSink instance
@@ -36,5 +44,7 @@ namespace DawgLog {
 
     private:
         std::string app_;
+        std::size_t chunk_bytes_;
+        std::atomic<std::uint64_t> next_id_{0};
     };
 } // namespace DawgLog
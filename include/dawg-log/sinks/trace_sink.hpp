@@ -0,0 +1,62 @@
+#pragma once
+#include "sink.hpp"
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+namespace DawgLog {
+    /**
+     * @brief Sink writing the Chrome trace event format
+     *
+     * Every record becomes one event in the JSON Array Format understood by
+     * chrome://tracing and the Perfetto UI. Timing spans become complete ("X")
+     * events spanning their duration; other records become thread-scoped instant
+     * ("i") events. Each event carries the process id, the record's thread id and
+     * its timestamp in microseconds. Level, message and source location are put in
+     * the event's args.
+     *
+     * Events are buffered in memory and written as whole events. The closing
+     * bracket of the array is optional in this format, so the file can be loaded
+     * at any time, even if the process dies before the sink is destroyed.
+     *
+     * The formatted text passed to write() is ignored, so the formatter of a
+     * target using this sink has no effect on the output.
+     */
+    class TraceSink : public Sink {
+    public:
+        /**
+         * @brief Create a trace file, replacing any existing one
+         *
+         * @param path Path of the trace file
+         * @param buffer_bytes Events are written once this much output is buffered
+         */
+        explicit TraceSink(std::string path, std::size_t buffer_bytes = 64 * 1024);
+
+        /** Writes buffered events and terminates the JSON array */
+        ~TraceSink() override;
+
+        /**
+         * @brief Append the record as a trace event
+         *
+         * The formatted string is ignored; the event is built from the record fields.
+         */
+        void write(const Record &r, std::string_view formatted) override;
+
+        /** Write all buffered events to the file */
+        void flush() override;
+
+        [[nodiscard]] bool healthy() const override;
+
+    private:
+        void flush_locked();
+
+        std::string path_;
+        std::size_t buffer_bytes_;
+        std::string buffer_;
+        int fd_{-1};
+        int pid_{0};
+        bool first_{true};
+        bool healthy_{true};
+        mutable std::mutex m_;
+    };
+} // namespace DawgLog
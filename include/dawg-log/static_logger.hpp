@@ -0,0 +1,162 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <fmt/core.h>
+#include "base_logger.hpp"
+#include "concepts.hpp"
+#include "level.hpp"
+#include "record.hpp"
+#include "src_location.hpp"
+
+namespace DawgLog {
+    /**
+     * @brief A sink and formatter pair stored by value in a StaticLogger
+     *
+     * @tparam S Sink type, e.g. FileSink
+     * @tparam F Formatter type, e.g. JsonFormatter; default constructed
+     */
+    template<SinkLike S, FormatterLike F>
+    struct Target {
+        using sink_type = S;
+        using formatter_type = F;
+
+        /** Construct the sink from the given arguments */
+        template<typename... SinkArgs>
+        explicit Target(SinkArgs &&... sink_args) : sink(std::forward<SinkArgs>(sink_args)...) {}
+
+        S sink;
+        F formatter;
+    };
+
+    /**
+     * @brief Logger whose targets are fixed at compile time
+     *
+     * Each Target is stored inline and called through qualified, non-virtual calls
+     * (`sink.S::write`, `formatter.F::format`), so the whole path from the log call
+     * to the sink can be inlined. It is meant for services whose output layout never
+     * changes at runtime. It has only a minimum level: no filters, backtrace, metrics
+     * or runtime reconfiguration.
+     *
+     * Usage example:
+     * ```cpp
+     * using AppLogger = StaticLogger<Target<FileSink, JsonFormatter>, Target<ConsoleSink, TextFormatter>>;
+     * AppLogger logger{"my-app", "/var/log/app.json", "my-app"};  // one sink argument per target
+     * auto net = logger.tagged("net");
+     * TAG_INFO(net, "listening on {}", port);
+     * ```
+     *
+     * @tparam Targets One Target<S, F> per output
+     */
+    template<typename... Targets>
+    class StaticLogger {
+    public:
+        /**
+         * @brief Construct the logger and its targets
+         *
+         * @param app_name Application name stamped on every record
+         * @param sink_args One constructor argument per target, passed to its sink
+         */
+        template<typename... SinkArgs>
+            requires (sizeof...(SinkArgs) == sizeof...(Targets))
+        explicit StaticLogger(std::string app_name, SinkArgs &&... sink_args)
+            : app_name_(std::move(app_name)), targets_(std::forward<SinkArgs>(sink_args)...) {}
+
+        StaticLogger(const StaticLogger &) = delete;
+
+        StaticLogger &operator=(const StaticLogger &) = delete;
+
+        /**
+         * @brief Log a message to every target
+         *
+         * @return std::string The formatted message, or an empty string below the level
+         */
+        template<typename... Args>
+        std::string log(LogLevel lvl, std::string_view tag, const SourceLocation &src,
+                        fmt::string_view fmt_str, Args &&... args) {
+            if (lvl < level_.load(std::memory_order_relaxed)) {
+                return {};
+            }
+            std::string msg = Logger::format_message(fmt_str, std::forward<Args>(args)...);
+            const Record rec{lvl, tag, src, app_name_, msg};
+            std::apply([&rec](auto &... target) { (write(target, rec), ...); }, targets_);
+            return msg;
+        }
+
+        /** @brief Set the minimum level of records that are emitted */
+        void set_level(LogLevel lvl) { level_.store(lvl, std::memory_order_relaxed); }
+
+        /** @return LogLevel The current minimum level */
+        [[nodiscard]] LogLevel level() const { return level_.load(std::memory_order_relaxed); }
+
+        /** @return auto& The target at position I, to reach its sink or formatter */
+        template<std::size_t I>
+        auto &target() { return std::get<I>(targets_); }
+
+        /** @brief Flush every sink that supports it */
+        void flush() {
+            std::apply([](auto &... target) { (flush_sink(target.sink), ...); }, targets_);
+        }
+
+        /** Tagged front end with TaggedLogger's interface */
+        class Tagged;
+
+        /** @return Tagged A tagged logger writing through this logger */
+        Tagged tagged(std::string tag) { return Tagged(*this, std::move(tag)); }
+
+    private:
+        template<typename T>
+        static void write(T &target, const Record &rec) {
+            using S = typename T::sink_type;
+            using F = typename T::formatter_type;
+            target.sink.S::write(rec, target.formatter.F::format(rec));
+        }
+
+        template<typename S>
+        static void flush_sink(S &sink) {
+            if constexpr (requires { sink.S::flush(); }) {
+                sink.S::flush();
+            }
+        }
+
+        std::string app_name_;
+        std::atomic<LogLevel> level_{LogLevel::debug};
+        std::tuple<Targets...> targets_;
+    };
+
+    /**
+     * @brief TaggedLogger counterpart for a StaticLogger
+     *
+     * Has the same level methods as TaggedLogger, so the TAG_* macros work with either.
+     */
+    template<typename... Targets>
+    class StaticLogger<Targets...>::Tagged {
+    public:
+        Tagged(StaticLogger &logger, std::string tag) : logger_(&logger), tag_(std::move(tag)) {}
+
+#define X(name, general, str, syslog) \
+        template <typename... Args> \
+        void name(const SourceLocation& src, fmt::string_view fmt_str, Args&&... args) { \
+            logger_->log(LogLevel::name, tag_, src, fmt_str, std::forward<Args>(args)...); \
+        }
+        LOG_LEVELS_XMACRO
+#undef X
+
+        template<ExceptionType E, typename... Args>
+        void throw_error(const SourceLocation &src, fmt::string_view fmt_str, Args &&... args) {
+            auto error_msg = Logger::format_message(fmt_str, std::forward<Args>(args)...);
+            logger_->log(LogLevel::error, tag_, src, "{}", error_msg);
+            throw E{error_msg};
+        }
+
+        /** @return const std::string& The tag of this logger */
+        [[nodiscard]] const std::string &tag() const { return tag_; }
+
+    private:
+        StaticLogger *logger_;
+        std::string tag_;
+    };
+} // namespace DawgLog
@@ -0,0 +1,103 @@
+#pragma once
+#include "level.hpp"
+#include <atomic>
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace DawgLog {
+    /**
+     * @brief Settings for routing the process's stdout and stderr through the logger
+     */
+    struct StdioCaptureOptions {
+        /** Capture is active */
+        bool enabled{false};
+
+        /** Tag of the captured records */
+        std::string tag{"stdio"};
+
+        /** Level of lines written to stdout */
+        LogLevel level{LogLevel::info};
+
+        /** Level of lines written to stderr */
+        LogLevel stderr_level{LogLevel::warning};
+    };
+
+    /**
+     * @brief Redirects file descriptors 1 and 2 into pipes read by a background thread
+     *
+     * Output that third-party code writes to stdout or stderr, through any API, ends
+     * up in the pipes. The reader thread drains them with large non-blocking reads,
+     * splits the data into lines and passes each non-empty line to the handler.
+     * Lines longer than 64 KiB are passed on in pieces.
+     *
+     * The original descriptors stay available through original_stdout() and
+     * original_stderr(); ConsoleSink writes to them through an OriginalStdioGuard,
+     * which keeps them from being closed underneath it. The destructor puts
+     * them back and hands the remaining output to the handler. Only one capture can
+     * be active at a time.
+     */
+    class StdioCapture {
+    public:
+        /** Receives one line; stream is 1 for stdout and 2 for stderr */
+        using Handler = std::function<void(int stream, std::string_view line)>;
+
+        /**
+         * @brief Redirect stdout and stderr and start the reader thread
+         *
+         * @param handler Called on the reader thread for every captured line
+         * @throws std::system_error If the pipes cannot be set up
+         * @throws std::logic_error If another capture is active
+         */
+        explicit StdioCapture(Handler handler);
+
+        /** Restores stdout and stderr and drains the pipes */
+        ~StdioCapture();
+
+        StdioCapture(const StdioCapture &) = delete;
+
+        StdioCapture &operator=(const StdioCapture &) = delete;
+
+    private:
+        void run();
+
+        Handler handler_;
+        int saved_out_{-1};
+        int saved_err_{-1};
+        int read_out_{-1};
+        int read_err_{-1};
+        std::atomic<bool> stop_{false};
+        std::thread thread_;
+    };
+
+    /** @return int Descriptor of the real stdout, 1 unless a StdioCapture is active */
+    int original_stdout();
+
+    /** @return int Descriptor of the real stderr, 2 unless a StdioCapture is active */
+    int original_stderr();
+
+    /**
+     * @brief Keeps the descriptors of original_stdout() and original_stderr() open while held
+     *
+     * A StdioCapture that ends switches back to 1 and 2 only once every guard taken
+     * before has been released, and closes its saved descriptors after that, so a
+     * writer may use out() and err() until its guard goes away.
+     */
+    class OriginalStdioGuard {
+    public:
+        OriginalStdioGuard();
+
+        /** @return int Descriptor of the real stdout */
+        [[nodiscard]] int out() const { return out_; }
+
+        /** @return int Descriptor of the real stderr */
+        [[nodiscard]] int err() const { return err_; }
+
+    private:
+        std::shared_lock<std::shared_mutex> lock_;
+        int out_;
+        int err_;
+    };
+} // namespace DawgLog
@@ -44,7 +44,8 @@ namespace DawgLog {
 
         template<ExceptionType E, typename... Args>
         void throw_error(const SourceLocation& src, fmt::string_view fmt_str, Args&&... args) { \
-            auto error_msg = Logger::instance().log(LogLevel::error, tag_, src, fmt_str, std::forward<Args>(args)...); \
+            auto error_msg = Logger::format_message(fmt_str, std::forward<Args>(args)...); \
+            Logger::instance().log(LogLevel::error, tag_, src, "{}", error_msg); \
             throw E{error_msg};
         }
 
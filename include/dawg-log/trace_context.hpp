@@ -0,0 +1,75 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace DawgLog {
+    /**
+     * @brief Distributed tracing identifiers attached to records
+     *
+     * Stored inline as raw bytes (W3C Trace Context sizes), so copying it into a
+     * record never allocates. An all-zero trace id means "no trace".
+     */
+    struct TraceContext {
+        /** 16-byte trace identifier */
+        std::array<std::uint8_t, 16> trace_id{};
+
+        /** 8-byte span identifier */
+        std::array<std::uint8_t, 8> span_id{};
+
+        /** @return bool True if a trace id is set */
+        [[nodiscard]] bool valid() const {
+            for (const auto b : trace_id) {
+                if (b != 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @brief Parse lowercase or uppercase hex ids, e.g. from a traceparent header
+         *
+         * @param trace_hex 32 hex digits
+         * @param span_hex 16 hex digits
+         * @param out Receives the parsed ids on success
+         * @return bool True if both ids were well-formed
+         */
+        static bool from_hex(std::string_view trace_hex, std::string_view span_hex, TraceContext &out);
+    };
+
+    /**
+     * @brief Set the trace context attached to records logged by the calling thread
+     * @param ctx The ids to attach; pass a default TraceContext to clear
+     */
+    void set_trace_context(const TraceContext &ctx);
+
+    /**
+     * @brief Get the calling thread's current trace context
+     * @return const TraceContext& The active ids (invalid when none is set)
+     */
+    const TraceContext &current_trace_context();
+
+    /**
+     * @brief RAII helper that sets the thread's trace context for a scope
+     *
+     * Restores the previous context on destruction, so scopes can nest.
+     */
+    class TraceScope {
+    public:
+        explicit TraceScope(const TraceContext &ctx) : previous_(current_trace_context()) {
+            set_trace_context(ctx);
+        }
+
+        ~TraceScope() {
+            set_trace_context(previous_);
+        }
+
+        TraceScope(const TraceScope &) = delete;
+
+        TraceScope &operator=(const TraceScope &) = delete;
+
+    private:
+        TraceContext previous_;
+    };
+} // namespace DawgLog
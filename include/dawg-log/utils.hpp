@@ -1,12 +1,18 @@
 #pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <map>
+#include <vector>
 
 namespace DawgLog {
     enum class SinkType {
         CONSOLE,
         SYSLOG,
-        FILE
+        FILE,
+        TRACE
     };
 
     enum class FormatterType {
@@ -14,6 +20,15 @@ namespace DawgLog {
         TEXT
     };
 
+    /** Sink decorators that config.json can stack around a target's sink ("wrap") */
+    enum class SinkWrapType {
+        ASYNC,
+        BUFFERED,
+        LEVEL_FILTER,
+        SAMPLED,
+        RATE_LIMITED
+    };
+
     /**
      * @brief Creates a formatted timestamp string in HH:MM:SS format
      *
@@ -26,12 +41,104 @@ namespace DawgLog {
      */
     std::string make_timestamp();
 
+    /**
+     * @brief Formats the given time point as a HH:MM:SS timestamp string
+     *
+     * @param time The wall-clock time to format
+     * @return std::string Formatted timestamp in "HH:MM:SS" format
+     */
+    std::string make_timestamp(std::chrono::system_clock::time_point time);
+
+    /**
+     * @brief Returns the OS thread id of the calling thread
+     *
+     * The id is looked up once per thread and cached.
+     *
+     * @return std::uint64_t Kernel thread id (gettid on Linux)
+     */
+    std::uint64_t current_thread_id();
+
+    /**
+     * @brief Returns the next value of a fast per-thread pseudo-random generator
+     *
+     * xorshift64* seeded per thread; not suitable for cryptographic use.
+     *
+     * @return std::uint64_t Pseudo-random 64-bit value
+     */
+    std::uint64_t fast_random();
+
+    /**
+     * @brief Returns true with the given probability
+     *
+     * @param probability Chance in [0, 1]; values outside are clamped
+     * @return bool True if the event was sampled
+     */
+    bool random_chance(double probability);
+
+    /**
+     * @brief Encodes bytes as lowercase hexadecimal
+     *
+     * Uses SSE2 to encode 16 bytes per step where available, with a scalar tail.
+     * The output is not NUL-terminated.
+     *
+     * @param data Bytes to encode
+     * @param len Number of bytes
+     * @param out Destination for exactly 2 * len characters
+     */
+    void hex_encode(const std::uint8_t *data, std::size_t len, char *out);
+
+    /**
+     * @brief Largest position not past pos that does not split a UTF-8 sequence
+     *
+     * @param text The text being cut
+     * @param pos Desired cut position, at most text.size()
+     * @return std::size_t pos, moved back over continuation bytes
+     */
+    std::size_t utf8_boundary(std::string_view text, std::size_t pos);
+
+    /**
+     * @brief Length of text without a UTF-8 sequence cut short at its end
+     *
+     * Used when text is a prefix of a longer message, so the byte after it is not
+     * available to utf8_boundary(). Malformed tails are kept as they are.
+     *
+     * @param text The prefix
+     * @return std::size_t text.size(), less an incomplete trailing sequence
+     */
+    std::size_t utf8_complete_length(std::string_view text);
+
+    /**
+     * @brief Split text into pieces of at most max_bytes, cut on UTF-8 boundaries
+     *
+     * A piece only ends inside a sequence when the cut cannot move back, e.g. a run
+     * of continuation bytes longer than max_bytes, so malformed input still splits.
+     *
+     * @param text The text to split
+     * @param max_bytes Largest piece, 0 for no limit
+     * @return std::vector<std::string_view> Views into text covering it in order
+     */
+    std::vector<std::string_view> split_utf8_chunks(std::string_view text, std::size_t max_bytes);
+
+    /**
+     * @brief Shorten an oversized message and mark how much was cut
+     *
+     * If total_bytes exceeds max_bytes, the first max_bytes of text (less any UTF-8
+     * sequence they cut) are kept and " [truncated N bytes]" is appended, N counting
+     * every byte not kept. Otherwise text is returned unchanged.
+     *
+     * @param text The message, or at least its first max_bytes bytes
+     * @param max_bytes Number of message bytes to keep
+     * @param total_bytes Full length of the message before any cut
+     * @return std::string The message to log
+     */
+    std::string truncate_message(std::string_view text, std::size_t max_bytes, std::size_t total_bytes);
+
     /**
      * @brief Gets the static mapping of sink type strings to SinkType enum values
      *
      * This function returns a constant reference to a map that associates string
      * representations of sink types with their corresponding enum values. The mapping
-     * includes "console" -> CONSOLE and "syslog" -> SYSLOG.
+     * includes "console" -> CONSOLE, "syslog" -> SYSLOG, "file" -> FILE and "trace" -> TRACE.
      *
      * @return const std::map<std::string, SinkType>& Reference to the sink type mapping
      */
@@ -71,4 +178,14 @@ namespace DawgLog {
      * @return FormatterType The corresponding FormatterType enum value
      */
     FormatterType string_to_formatter_type(const std::string &type);
+
+    /**
+     * @brief Converts a decorator name ("async", "buffered", "level_filter", "sampled",
+     * "rate_limited") to a SinkWrapType enum value
+     *
+     * @param type The decorator name
+     * @param out Receives the decorator type on success
+     * @return bool False if the name is unknown
+     */
+    bool parse_sink_wrap_type(const std::string &type, SinkWrapType &out);
 } // namespace DawgLog
@@ -0,0 +1,102 @@
+#include "dawg-log/sinks/async_sink.hpp"
+#include "dawg-log/probes.hpp"
+#include <chrono>
+
+using namespace DawgLog;
+
+namespace {
+/** Upper bound on a single wait, so shutdown and flush never hang on a missed wakeup */
+constexpr std::chrono::milliseconds WAIT_SLICE{100};
+}
+
+AsyncSink::AsyncSink(SinkPtr inner, std::size_t capacity, bool drop_when_full)
+    : inner_(std::move(inner)), capacity_(capacity == 0 ? 1 : capacity), drop_when_full_(drop_when_full) {
+    worker_ = std::thread([this] { run(); });
+}
+
+AsyncSink::~AsyncSink() {
+    {
+        std::lock_guard lock(m_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    worker_.join();
+}
+
+void AsyncSink::write(const Record& r, std::string_view formatted) {
+    std::unique_lock lock(m_);
+    while (queue_.size() >= capacity_ && !stop_) {
+        if (drop_when_full_) {
+            ++dropped_;
+            return;
+        }
+        done_cv_.wait_for(lock, WAIT_SLICE);
+    }
+    queue_.push_back(Item{r, std::string(formatted)});
+    ++enqueued_;
+    DAWGLOG_PROBE2(enqueue, this, queue_.size());
+    lock.unlock();
+    work_cv_.notify_one();
+}
+
+void AsyncSink::run() {
+    std::deque<Item> batch;
+    std::unique_lock lock(m_);
+    while (true) {
+        if (queue_.empty()) {
+            if (stop_) {
+                return;
+            }
+            work_cv_.wait_for(lock, WAIT_SLICE);
+            continue;
+        }
+        batch.swap(queue_);
+        DAWGLOG_PROBE2(dequeue, this, batch.size());
+        lock.unlock();
+        done_cv_.notify_all();
+        for (const auto &item : batch) {
+            inner_->write(item.record, item.formatted);
+        }
+        const auto count = batch.size();
+        batch.clear();
+        lock.lock();
+        if (queue_.empty()) {
+            lock.unlock();
+            inner_->flush();
+            lock.lock();
+        }
+        written_ += count;
+        done_cv_.notify_all();
+    }
+}
+
+void AsyncSink::flush() {
+    std::unique_lock lock(m_);
+    const std::uint64_t target = enqueued_;
+    while (written_ < target) {
+        done_cv_.wait_for(lock, WAIT_SLICE);
+    }
+    lock.unlock();
+    inner_->flush();
+}
+
+bool AsyncSink::healthy() const {
+    return inner_->healthy();
+}
+
+bool AsyncSink::probe() {
+    return inner_->probe();
+}
+
+bool AsyncSink::reopen() {
+    return inner_->reopen();
+}
+
+int AsyncSink::native_fd() const {
+    return inner_->native_fd();
+}
+
+std::uint64_t AsyncSink::dropped() const {
+    std::lock_guard lock(m_);
+    return dropped_;
+}
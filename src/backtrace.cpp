@@ -0,0 +1,58 @@
+#include "dawg-log/backtrace.hpp"
+#include <iterator>
+#include <thread>
+
+using namespace DawgLog;
+
+Record DeferredRecord::materialize(std::string_view app_name, std::size_t max_message_bytes) const {
+    std::string message;
+    if (max_message_bytes == 0) {
+        message = fmt::vformat(format, args);
+    } else {
+        std::string out;
+        const auto result = fmt::vformat_to_n(std::back_inserter(out), max_message_bytes, format, args);
+        message = truncate_message(out, max_message_bytes, result.size);
+    }
+    Record rec{level, tag, src, app_name, std::move(message), time, monotonic, thread_id, seq_mode, seq, context,
+               trace};
+    rec.duration = duration;
+    return rec;
+}
+
+BacktraceBuffer::BacktraceBuffer(std::size_t capacity)
+    : slots_(std::make_unique<Slot[]>(capacity == 0 ? 1 : capacity)), capacity_(capacity == 0 ? 1 : capacity) {
+}
+
+void BacktraceBuffer::push(DeferredRecord rec) {
+    const std::uint64_t seq = head_.fetch_add(1, std::memory_order_relaxed) + 1;
+    auto &slot = slots_[seq % capacity_];
+    if (slot.busy.test_and_set(std::memory_order_acquire)) {
+        return;
+    }
+    // A slower writer from an earlier lap must not overwrite a newer record.
+    if (slot.seq < seq) {
+        slot.seq = seq;
+        slot.rec = std::move(rec);
+    }
+    slot.busy.clear(std::memory_order_release);
+}
+
+std::vector<DeferredRecord> BacktraceBuffer::drain() {
+    const std::uint64_t head = head_.load(std::memory_order_acquire);
+    const std::uint64_t first = head > capacity_ ? head - capacity_ + 1 : 1;
+    std::vector<DeferredRecord> out;
+    out.reserve(static_cast<std::size_t>(head - first + 1));
+    for (std::uint64_t seq = first; seq <= head; ++seq) {
+        auto &slot = slots_[seq % capacity_];
+        // Writers hold a slot only for a move; yield instead of burning the CPU if one is preempted.
+        while (slot.busy.test_and_set(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        if (slot.seq == seq && slot.rec) {
+            out.push_back(std::move(*slot.rec));
+            slot.rec.reset();
+        }
+        slot.busy.clear(std::memory_order_release);
+    }
+    return out;
+}
@@ -0,0 +1,58 @@
+#include "dawg-log/sinks/buffered_sink.hpp"
+
+using namespace DawgLog;
+
+BufferedSink::BufferedSink(SinkPtr inner, std::size_t capacity)
+    : inner_(std::move(inner)), capacity_(capacity) {}
+
+BufferedSink::~BufferedSink() {
+    std::lock_guard lock(m_);
+    flush_locked();
+}
+
+void BufferedSink::write(const Record& r, std::string_view formatted) {
+    std::lock_guard lock(m_);
+    if (r.level >= LogLevel::warning) {
+        flush_locked();
+        inner_->write(r, formatted);
+        return;
+    }
+    pending_.push_back(FormattedRecord{r, std::string(formatted)});
+    pending_bytes_ += formatted.size() + 1;
+    if (pending_bytes_ >= capacity_) {
+        flush_locked();
+    }
+}
+
+void BufferedSink::flush_locked() {
+    if (pending_.empty()) {
+        return;
+    }
+    inner_->write_batch(pending_);
+    pending_.clear();
+    pending_bytes_ = 0;
+}
+
+void BufferedSink::flush() {
+    std::lock_guard lock(m_);
+    flush_locked();
+    inner_->flush();
+}
+
+bool BufferedSink::healthy() const {
+    return inner_->healthy();
+}
+
+bool BufferedSink::probe() {
+    return inner_->probe();
+}
+
+bool BufferedSink::reopen() {
+    std::lock_guard lock(m_);
+    flush_locked();
+    return inner_->reopen();
+}
+
+int BufferedSink::native_fd() const {
+    return inner_->native_fd();
+}
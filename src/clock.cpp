@@ -0,0 +1,244 @@
+#include "dawg-log/clock.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define DAWGLOG_HAS_TSC 1
+#endif
+
+using namespace DawgLog;
+
+namespace {
+std::atomic<ClockSource> source{ClockSource::REALTIME};
+std::atomic<bool> with_monotonic{false};
+/** Wall time minus CLOCK_MONOTONIC, fixed when MONOTONIC is selected */
+std::atomic<std::int64_t> monotonic_offset_ns{0};
+
+std::int64_t read_clock(clockid_t id) {
+    timespec ts{};
+    ::clock_gettime(id, &ts);
+    return static_cast<std::int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+std::chrono::system_clock::time_point to_time_point(std::int64_t ns) {
+    return std::chrono::system_clock::time_point{
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds{ns})};
+}
+
+#ifdef DAWGLOG_HAS_TSC
+/**
+ * Conversion from TSC ticks to wall and monotonic nanoseconds, published with a
+ * sequence lock: writers make seq odd while updating, readers retry on a change.
+ */
+struct TscCalibration {
+    std::atomic<std::uint64_t> seq{0};
+    std::atomic<std::uint64_t> base_tsc{0};
+    std::atomic<std::int64_t> base_wall_ns{0};
+    std::atomic<std::int64_t> base_mono_ns{0};
+    /** Nanoseconds per tick in 32.32 fixed point */
+    std::atomic<std::uint64_t> ns_per_tick{0};
+} tsc;
+
+struct TscSample {
+    std::uint64_t tsc;
+    std::int64_t mono_ns;
+};
+
+std::mutex calibrator_m;
+std::condition_variable calibrator_cv;
+bool calibrator_stop = false;
+std::thread calibrator;
+
+bool tsc_invariant() {
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 || eax < 0x80000007) {
+        return false;
+    }
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return (edx & (1u << 8)) != 0;
+}
+
+TscSample sample() {
+    return TscSample{__rdtsc(), read_clock(CLOCK_MONOTONIC)};
+}
+
+/** Convert a TSC reading; returns {wall_ns, mono_ns} */
+std::pair<std::int64_t, std::int64_t> tsc_convert(std::uint64_t now);
+
+/** Interval between recalibrations */
+constexpr std::int64_t RECALIBRATE_NS = 1000000000;
+
+/**
+ * Publish the frequency measured between two samples. With continuous set, the
+ * monotonic base continues from the value readers have reached at the anchor
+ * instead of jumping to CLOCK_MONOTONIC, and the remaining error is worked off by
+ * adjusting the rate over the next period, so monotonic_now() never steps back.
+ */
+void publish(const TscSample &from, const TscSample &to, bool continuous) {
+    const auto ticks = to.tsc - from.tsc;
+    if (ticks == 0) {
+        return;
+    }
+    auto mult = static_cast<std::uint64_t>(
+        (static_cast<unsigned __int128>(to.mono_ns - from.mono_ns) << 32) / ticks);
+    const std::int64_t wall = read_clock(CLOCK_REALTIME);
+    const TscSample anchor = sample();
+    std::int64_t mono = anchor.mono_ns;
+    if (continuous) {
+        mono = tsc_convert(anchor.tsc).second;
+        const std::int64_t error = std::clamp(anchor.mono_ns - mono, -RECALIBRATE_NS / 2, RECALIBRATE_NS / 2);
+        mult = static_cast<std::uint64_t>(static_cast<unsigned __int128>(mult) *
+                                          static_cast<std::uint64_t>(RECALIBRATE_NS + error) / RECALIBRATE_NS);
+    }
+    tsc.seq.fetch_add(1, std::memory_order_acq_rel);
+    tsc.base_tsc.store(anchor.tsc, std::memory_order_relaxed);
+    tsc.base_wall_ns.store(wall, std::memory_order_relaxed);
+    tsc.base_mono_ns.store(mono, std::memory_order_relaxed);
+    tsc.ns_per_tick.store(mult, std::memory_order_relaxed);
+    tsc.seq.fetch_add(1, std::memory_order_release);
+}
+
+std::pair<std::int64_t, std::int64_t> tsc_convert(std::uint64_t now) {
+    while (true) {
+        const auto seq = tsc.seq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            continue;
+        }
+        const auto base = tsc.base_tsc.load(std::memory_order_relaxed);
+        const auto wall = tsc.base_wall_ns.load(std::memory_order_relaxed);
+        const auto mono = tsc.base_mono_ns.load(std::memory_order_relaxed);
+        const auto mult = tsc.ns_per_tick.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (tsc.seq.load(std::memory_order_relaxed) != seq) {
+            continue;
+        }
+        // Readings taken on another core may be slightly behind the anchor.
+        const auto delta = now > base ? static_cast<std::int64_t>(
+                                            (static_cast<unsigned __int128>(now - base) * mult) >> 32)
+                                      : 0;
+        return {wall + delta, mono + delta};
+    }
+}
+
+void calibrate_loop(TscSample start) {
+    // Each pass measures the frequency over everything since start, so the estimate
+    // keeps improving, and re-anchors wall time to follow NTP adjustments.
+    std::unique_lock<std::mutex> lock(calibrator_m);
+    while (!calibrator_cv.wait_for(lock, std::chrono::nanoseconds{RECALIBRATE_NS}, [] { return calibrator_stop; })) {
+        publish(start, sample(), true);
+    }
+}
+
+void stop_calibrator() {
+    {
+        std::lock_guard<std::mutex> lock(calibrator_m);
+        calibrator_stop = true;
+    }
+    calibrator_cv.notify_all();
+    if (calibrator.joinable()) {
+        calibrator.join();
+    }
+    calibrator_stop = false;
+}
+
+bool start_calibrator() {
+    if (calibrator.joinable()) {
+        return true;
+    }
+    if (!tsc_invariant()) {
+        return false;
+    }
+    const TscSample start = sample();
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    publish(start, sample(), false);
+    calibrator = std::thread(calibrate_loop, start);
+    return true;
+}
+
+struct CalibratorGuard {
+    ~CalibratorGuard() { stop_calibrator(); }
+} calibrator_guard;
+#endif
+}
+
+void DawgLog::set_clock_source(ClockSource requested) {
+    static std::mutex m;
+    std::lock_guard<std::mutex> lock(m);
+    if (requested == ClockSource::TSC) {
+#ifdef DAWGLOG_HAS_TSC
+        if (start_calibrator()) {
+            source.store(ClockSource::TSC, std::memory_order_release);
+            return;
+        }
+#endif
+        std::cerr << "Invariant TSC not available. Falling back to 'monotonic' clock." << std::endl;
+        requested = ClockSource::MONOTONIC;
+    }
+    if (requested == ClockSource::MONOTONIC) {
+        monotonic_offset_ns.store(read_clock(CLOCK_REALTIME) - read_clock(CLOCK_MONOTONIC),
+                                  std::memory_order_relaxed);
+    }
+    source.store(requested, std::memory_order_release);
+#ifdef DAWGLOG_HAS_TSC
+    stop_calibrator();
+#endif
+}
+
+ClockSource DawgLog::clock_source() {
+    return source.load(std::memory_order_acquire);
+}
+
+std::chrono::system_clock::time_point DawgLog::clock_now() {
+    switch (source.load(std::memory_order_acquire)) {
+        case ClockSource::REALTIME_COARSE:
+            return to_time_point(read_clock(CLOCK_REALTIME_COARSE));
+        case ClockSource::MONOTONIC:
+            return to_time_point(read_clock(CLOCK_MONOTONIC) + monotonic_offset_ns.load(std::memory_order_relaxed));
+#ifdef DAWGLOG_HAS_TSC
+        case ClockSource::TSC:
+            return to_time_point(tsc_convert(__rdtsc()).first);
+#endif
+        default:
+            return std::chrono::system_clock::now();
+    }
+}
+
+std::chrono::nanoseconds DawgLog::monotonic_now() {
+#ifdef DAWGLOG_HAS_TSC
+    if (source.load(std::memory_order_acquire) == ClockSource::TSC) {
+        return std::chrono::nanoseconds{tsc_convert(__rdtsc()).second};
+    }
+#endif
+    return std::chrono::nanoseconds{read_clock(CLOCK_MONOTONIC)};
+}
+
+void DawgLog::set_monotonic_timestamps(bool enabled) {
+    with_monotonic.store(enabled, std::memory_order_relaxed);
+}
+
+bool DawgLog::monotonic_timestamps() {
+    return with_monotonic.load(std::memory_order_relaxed);
+}
+
+ClockSource DawgLog::string_to_clock_source(const std::string &name) {
+    static const std::map<std::string, ClockSource> mapping = {
+        {"realtime", ClockSource::REALTIME},
+        {"realtime_coarse", ClockSource::REALTIME_COARSE},
+        {"monotonic", ClockSource::MONOTONIC},
+        {"tsc", ClockSource::TSC}
+    };
+    const auto it = mapping.find(name);
+    if (it == mapping.end()) {
+        std::cerr << "Unknown clock '" << name << "'. Falling back to 'realtime'." << std::endl;
+        return ClockSource::REALTIME;
+    }
+    return it->second;
+}
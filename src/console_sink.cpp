@@ -1,15 +1,63 @@
 #include "dawg-log/sinks/console_sink.hpp"
-#include <iostream>
+#include "dawg-log/stdio_capture.hpp"
+#include <cerrno>
+#include <sys/uio.h>
+#include <unistd.h>
 
 using namespace DawgLog;
 
 void ConsoleSink::write(const Record& r, std::string_view formatted) {
     std::lock_guard lock(m_);
-    if (r.level >= LogLevel::warning) {
-        std::cerr << formatted << '\n';
-        std::cerr.flush();
-    } else {
-        std::cout << formatted << '\n';
-        std::cout.flush();
+    // Read the descriptor under the guard: an ending StdioCapture closes the old one.
+    const OriginalStdioGuard stdio;
+    const int fd = r.level >= LogLevel::warning ? stdio.err() : stdio.out();
+    char newline = '\n';
+    iovec iov[2] = {{const_cast<char *>(formatted.data()), formatted.size()}, {&newline, 1}};
+    int iov_index = 0;
+    while (iov_index < 2) {
+        const ssize_t n = ::writev(fd, iov + iov_index, 2 - iov_index);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        auto left = static_cast<std::size_t>(n);
+        while (iov_index < 2 && left >= iov[iov_index].iov_len) {
+            left -= iov[iov_index].iov_len;
+            ++iov_index;
+        }
+        if (iov_index < 2) {
+            iov[iov_index].iov_base = static_cast<char *>(iov[iov_index].iov_base) + left;
+            iov[iov_index].iov_len -= left;
+        }
     }
-}
\ No newline at end of file
+}
+
+void ConsoleSink::write_batch(std::span<const FormattedRecord> batch) {
+    std::string joined;
+    std::size_t first = 0;
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        const bool to_stderr = batch[i].record.level >= LogLevel::warning;
+        if (i + 1 < batch.size() && (batch[i + 1].record.level >= LogLevel::warning) == to_stderr) {
+            continue;
+        }
+        if (first == i) {
+            write(batch[i].record, batch[i].text);
+        } else {
+            joined.clear();
+            for (std::size_t j = first; j <= i; ++j) {
+                joined.append(batch[j].text);
+                if (j < i) {
+                    joined += '\n';
+                }
+            }
+            write(batch[first].record, joined);
+        }
+        first = i + 1;
+    }
+}
+
+int ConsoleSink::native_fd() const {
+    return original_stderr();
+}
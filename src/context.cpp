@@ -0,0 +1,34 @@
+#include "dawg-log/context.hpp"
+#include <nlohmann/json.hpp>
+
+using namespace DawgLog;
+
+namespace {
+thread_local std::shared_ptr<const ContextFrame> current_frame;
+}
+
+Context::Context(std::initializer_list<ContextField> fields) : previous_(current_frame) {
+    auto frame = std::make_shared<ContextFrame>();
+    if (previous_) {
+        *frame = *previous_;
+    }
+    for (const auto &field : fields) {
+        if (!frame->text.empty()) {
+            frame->text += ' ';
+            frame->json += ',';
+        }
+        frame->text.append(field.key).append(1, '=').append(field.value);
+        frame->json += nlohmann::json(field.key).dump();
+        frame->json += ':';
+        frame->json += nlohmann::json(field.value).dump();
+    }
+    current_frame = std::move(frame);
+}
+
+Context::~Context() {
+    current_frame = std::move(previous_);
+}
+
+std::shared_ptr<const ContextFrame> Context::current() {
+    return current_frame;
+}
@@ -0,0 +1,142 @@
+#include "dawg-log/control_server.hpp"
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace DawgLog;
+
+namespace {
+/** How often the server thread checks for shutdown while idle */
+constexpr int POLL_MS = 200;
+
+/** A client that sends nothing for this long is disconnected so others can be served */
+constexpr int IDLE_MS = 30000;
+
+/** A reply that cannot be sent within this time drops the client */
+constexpr timeval SEND_TIMEOUT{5, 0};
+
+/** Requests longer than this close the connection */
+constexpr std::size_t MAX_LINE = 4096;
+
+bool write_all(int fd, std::string_view data) {
+    while (!data.empty()) {
+        const ssize_t n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(n));
+    }
+    return true;
+}
+}
+
+ControlServer::ControlServer(std::string path, Handler handler)
+    : path_(std::move(path)), handler_(std::move(handler)) {
+    sockaddr_un addr{};
+    if (path_.size() >= sizeof(addr.sun_path)) {
+        throw std::system_error(ENAMETOOLONG, std::generic_category(), "Control socket path too long");
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path_.c_str(), path_.size() + 1);
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to create control socket");
+    }
+    // Only a stale socket is replaced; a mistyped path must not delete a regular file.
+    struct stat st{};
+    if (::lstat(path_.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            ::close(listen_fd_);
+            throw std::system_error(EEXIST, std::generic_category(),
+                                    "Control socket path exists and is not a socket: " + path_);
+        }
+        ::unlink(path_.c_str());
+    }
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        ::chmod(path_.c_str(), S_IRUSR | S_IWUSR) != 0 || ::lstat(path_.c_str(), &st) != 0 ||
+        ::listen(listen_fd_, 4) != 0) {
+        const int err = errno;
+        ::close(listen_fd_);
+        throw std::system_error(err, std::generic_category(), "Failed to bind control socket " + path_);
+    }
+    dev_ = st.st_dev;
+    ino_ = st.st_ino;
+    thread_ = std::thread([this] { run(); });
+}
+
+ControlServer::~ControlServer() {
+    stop_.store(true, std::memory_order_relaxed);
+    thread_.join();
+    ::close(listen_fd_);
+    // Leave the path alone if another server has bound it since.
+    struct stat st{};
+    if (::lstat(path_.c_str(), &st) == 0 && st.st_dev == dev_ && st.st_ino == ino_) {
+        ::unlink(path_.c_str());
+    }
+}
+
+void ControlServer::run() {
+    while (!stop_.load(std::memory_order_relaxed)) {
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, POLL_MS) <= 0) {
+            continue;
+        }
+        const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &SEND_TIMEOUT, sizeof(SEND_TIMEOUT));
+        serve(fd);
+        ::close(fd);
+    }
+}
+
+void ControlServer::serve(int fd) {
+    std::string buffer;
+    char chunk[512];
+    int idle_ms = 0;
+    while (!stop_.load(std::memory_order_relaxed)) {
+        pollfd pfd{fd, POLLIN, 0};
+        const int ready = ::poll(&pfd, 1, POLL_MS);
+        if (ready < 0 && errno != EINTR) {
+            return;
+        }
+        if (ready <= 0) {
+            idle_ms += POLL_MS;
+            if (idle_ms >= IDLE_MS) {
+                return;
+            }
+            continue;
+        }
+        idle_ms = 0;
+        const ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            return;
+        }
+        buffer.append(chunk, static_cast<std::size_t>(n));
+        std::size_t eol;
+        while ((eol = buffer.find('\n')) != std::string::npos) {
+            std::string_view line(buffer.data(), eol);
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            if (!write_all(fd, handler_(line))) {
+                return;
+            }
+            buffer.erase(0, eol + 1);
+        }
+        if (buffer.size() > MAX_LINE) {
+            write_all(fd, "error: request too long\n");
+            return;
+        }
+    }
+}
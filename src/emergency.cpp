@@ -0,0 +1,201 @@
+#include "dawg-log/emergency.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace DawgLog;
+
+namespace {
+constexpr std::size_t HEADER_BYTES = 128;
+constexpr std::size_t LINE_BYTES = 1024;
+
+struct Header {
+    char text[HEADER_BYTES];
+    std::size_t len;
+    /** Seconds to add to UTC for local time */
+    long utc_offset;
+};
+
+// Two slots so a handler never reads a header while it is being rewritten.
+Header headers[2];
+std::atomic<int> active_header{-1};
+
+/** Descriptors duplicated from one set_emergency_fds() call, owned by this table */
+struct FdTable {
+    std::atomic<int> fds[EMERGENCY_MAX_FDS];
+    std::atomic<std::size_t> count{0};
+};
+
+// Two tables, like the headers: a handler still writing through the previous set
+// keeps its descriptors open until the registration after next.
+FdTable tables[2];
+std::atomic<int> active_table{-1};
+std::mutex publish_m;
+
+/** Bounded appender over a stack buffer; output past the end is cut */
+struct Line {
+    char buf[LINE_BYTES];
+    std::size_t len{0};
+
+    void put(const char *s, std::size_t n) {
+        n = std::min(n, sizeof(buf) - 1 - len);
+        std::memcpy(buf + len, s, n);
+        len += n;
+    }
+
+    void put(const char *s) {
+        std::size_t n = 0;
+        while (s[n] != '\0') {
+            ++n;
+        }
+        put(s, n);
+    }
+
+    void put_dec(std::uint64_t v, std::size_t min_digits = 1) {
+        char tmp[20];
+        std::size_t n = 0;
+        do {
+            tmp[n++] = static_cast<char>('0' + v % 10);
+            v /= 10;
+        } while (v != 0 || n < min_digits);
+        while (n > 0) {
+            put(&tmp[--n], 1);
+        }
+    }
+
+    void put_signed(std::int64_t v) {
+        if (v < 0) {
+            put("-", 1);
+            put_dec(0 - static_cast<std::uint64_t>(v));
+        } else {
+            put_dec(static_cast<std::uint64_t>(v));
+        }
+    }
+
+    void put_hex(std::uint64_t v) {
+        static constexpr char digits[] = "0123456789abcdef";
+        char tmp[16];
+        std::size_t n = 0;
+        do {
+            tmp[n++] = digits[v & 0x0f];
+            v >>= 4;
+        } while (v != 0);
+        put("0x", 2);
+        while (n > 0) {
+            put(&tmp[--n], 1);
+        }
+    }
+};
+
+void write_all(const int fd, const char *data, std::size_t len) {
+    while (len > 0) {
+        const ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += n;
+        len -= static_cast<std::size_t>(n);
+    }
+}
+}
+
+void DawgLog::set_emergency_fds(const int* list, const std::size_t count) {
+    std::lock_guard lock(publish_m);
+    const int next = active_table.load(std::memory_order_acquire) == 0 ? 1 : 0;
+    FdTable &table = tables[next];
+    for (std::size_t i = 0; i < table.count.load(std::memory_order_relaxed); ++i) {
+        ::close(table.fds[i].load(std::memory_order_relaxed));
+    }
+    int originals[EMERGENCY_MAX_FDS];
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < count && n < EMERGENCY_MAX_FDS; ++i) {
+        const int fd = list[i];
+        bool seen = fd < 0;
+        for (std::size_t j = 0; j < n && !seen; ++j) {
+            seen = originals[j] == fd;
+        }
+        if (seen) {
+            continue;
+        }
+        const int copy = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+        if (copy >= 0) {
+            originals[n] = fd;
+            table.fds[n++].store(copy, std::memory_order_relaxed);
+        }
+    }
+    table.count.store(n, std::memory_order_relaxed);
+    active_table.store(next, std::memory_order_release);
+}
+
+void DawgLog::set_emergency_app_name(std::string_view app_name) {
+    const int next = active_header.load(std::memory_order_acquire) == 0 ? 1 : 0;
+    Header &h = headers[next];
+    h.len = std::min(app_name.size(), HEADER_BYTES - 1);
+    std::memcpy(h.text, app_name.data(), h.len);
+    h.text[h.len++] = ' ';
+
+    const std::time_t now = std::time(nullptr);
+    std::tm local{};
+    localtime_r(&now, &local);
+    h.utc_offset = local.tm_gmtoff;
+    active_header.store(next, std::memory_order_release);
+}
+
+void DawgLog::detail::emergency(const SourceLocation& src, const char* msg, const std::size_t len,
+                                const EmergencyValue kind, const std::uint64_t value) noexcept {
+    const int saved_errno = errno;
+    Line line;
+
+    long offset = 0;
+    const int header = active_header.load(std::memory_order_acquire);
+    if (header >= 0) {
+        line.put(headers[header].text, headers[header].len);
+        offset = headers[header].utc_offset;
+    } else {
+        line.put("DawgLog ");
+    }
+
+    timespec ts{};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    const long day = 24 * 60 * 60;
+    const long secs = ((static_cast<long>(ts.tv_sec) + offset) % day + day) % day;
+    line.put_dec(static_cast<std::uint64_t>(secs / 3600), 2);
+    line.put(":", 1);
+    line.put_dec(static_cast<std::uint64_t>(secs / 60 % 60), 2);
+    line.put(":", 1);
+    line.put_dec(static_cast<std::uint64_t>(secs % 60), 2);
+
+    line.put(" [EMERGENCY] CRITICAL: ");
+    line.put(msg, len);
+    if (kind == EmergencyValue::DEC) {
+        line.put(" ", 1);
+        line.put_signed(static_cast<std::int64_t>(value));
+    } else if (kind == EmergencyValue::HEX) {
+        line.put(" ", 1);
+        line.put_hex(value);
+    }
+    line.put(", SOURCE: ");
+    line.put(src.file);
+    line.put(":", 1);
+    line.put_signed(src.line);
+    line.buf[line.len++] = '\n';
+
+    const int active = active_table.load(std::memory_order_acquire);
+    const std::size_t count = active < 0 ? 0 : tables[active].count.load(std::memory_order_relaxed);
+    if (count == 0) {
+        write_all(STDERR_FILENO, line.buf, line.len);
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        write_all(tables[active].fds[i].load(std::memory_order_relaxed), line.buf, line.len);
+    }
+    errno = saved_errno;
+}
@@ -0,0 +1,132 @@
+#include "dawg-log/sinks/failover_sink.hpp"
+#include "dawg-log/emergency.hpp"
+#include <iostream>
+
+using namespace DawgLog;
+
+FailoverSink::FailoverSink(SinkPtr primary, std::vector<SinkPtr> fallbacks, FailoverOptions options)
+    : options_(options) {
+    sinks_.reserve(fallbacks.size() + 1);
+    sinks_.push_back(std::move(primary));
+    for (auto &sink : fallbacks) {
+        if (sink) {
+            sinks_.push_back(std::move(sink));
+        }
+    }
+    busy_since_ = std::make_unique<std::atomic<std::int64_t>[]>(sinks_.size());
+    for (std::size_t i = 0; i < sinks_.size(); ++i) {
+        busy_since_[i].store(0, std::memory_order_relaxed);
+    }
+    prober_ = std::thread([this] { probe_loop(); });
+}
+
+FailoverSink::~FailoverSink() {
+    {
+        std::lock_guard lock(probe_m_);
+        stop_ = true;
+    }
+    probe_cv_.notify_all();
+    if (prober_.joinable()) {
+        prober_.join();
+    }
+}
+
+void FailoverSink::write(const Record& r, std::string_view formatted) {
+    using clock = std::chrono::steady_clock;
+    for (std::size_t i = active_.load(std::memory_order_relaxed); i < sinks_.size(); ++i) {
+        const bool last = i + 1 == sinks_.size();
+        if (!last && stalled(i)) {
+            fail_over(i, "is stalled");
+            continue;
+        }
+        auto &sink = *sinks_[i];
+        const auto start = clock::now();
+        std::int64_t idle = 0;
+        const bool marked = busy_since_[i].compare_exchange_strong(idle, start.time_since_epoch().count(),
+                                                                   std::memory_order_relaxed);
+        sink.write(r, formatted);
+        if (marked) {
+            busy_since_[i].store(0, std::memory_order_relaxed);
+        }
+        const auto elapsed = clock::now() - start;
+
+        const bool ok = sink.healthy();
+        const bool slow = options_.latency_threshold.count() > 0 && elapsed > options_.latency_threshold;
+        if (ok && !slow) {
+            return;
+        }
+        if (!last) {
+            fail_over(i, ok ? "is too slow" : "failed");
+        }
+        if (ok) {
+            // The record made it, only later traffic moves on.
+            return;
+        }
+    }
+}
+
+bool FailoverSink::stalled(std::size_t index) const {
+    if (options_.latency_threshold.count() <= 0) {
+        return false;
+    }
+    const std::int64_t since = busy_since_[index].load(std::memory_order_relaxed);
+    if (since == 0) {
+        return false;
+    }
+    const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    return std::chrono::steady_clock::duration{now - since} > options_.latency_threshold;
+}
+
+void FailoverSink::fail_over(std::size_t index, const char* reason) {
+    std::size_t expected = index;
+    if (active_.compare_exchange_strong(expected, index + 1, std::memory_order_relaxed)) {
+        emergency_fds_changed();
+        std::cerr << "Log sink " << index << ' ' << reason << ", failing over to sink " << index + 1 << std::endl;
+    }
+}
+
+void FailoverSink::flush() {
+    for (auto &sink : sinks_) {
+        sink->flush();
+    }
+}
+
+bool FailoverSink::reopen() {
+    bool any = false;
+    for (auto &sink : sinks_) {
+        any = sink->reopen() || any;
+    }
+    return any;
+}
+
+bool FailoverSink::healthy() const {
+    for (const auto &sink : sinks_) {
+        if (sink->healthy()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int FailoverSink::native_fd() const {
+    return sinks_[active_.load(std::memory_order_relaxed)]->native_fd();
+}
+
+std::size_t FailoverSink::active_index() const {
+    return active_.load(std::memory_order_relaxed);
+}
+
+void FailoverSink::probe_loop() {
+    std::unique_lock lock(probe_m_);
+    while (!probe_cv_.wait_for(lock, options_.probe_interval, [this] { return stop_; })) {
+        if (active_.load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        if (!sinks_.front()->probe()) {
+            continue;
+        }
+        active_.store(0, std::memory_order_relaxed);
+        emergency_fds_changed();
+        std::cerr << "Log sink 0 recovered, switching back" << std::endl;
+    }
+}
@@ -1,20 +1,477 @@
 #include "dawg-log/sinks/file_sink.hpp"
+#include "dawg-log/emergency.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
 #include <iostream>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
 using namespace DawgLog;
 
-FileSink::FileSink(std::string path)
-    : path_(std::move(path)), out_(path_, std::ios::app) {
-    if (!out_.is_open()) {
-        std::cerr << "Failed to open log file: " << path_ << std::endl;
+namespace {
+// O_DIRECT transfers must be aligned in memory, file offset and length. 4 KiB
+// satisfies every logical block size in common use.
+constexpr std::size_t DIRECT_ALIGN = 4096;
+
+std::size_t align_up(std::size_t n) {
+    return (n + DIRECT_ALIGN - 1) & ~(DIRECT_ALIGN - 1);
+}
+}
+
+void FileSink::AlignedFree::operator()(char *p) const {
+    std::free(p);
+}
+
+FileSink::FileSink(std::string path, FileSinkOptions options)
+    : path_(std::move(path)), options_(options) {
+    std::lock_guard lock(m_);
+    open_locked();
+}
+
+FileSink::~FileSink() {
+    if (fd_ < 0) {
+        return;
+    }
+    release_locked();
+    ::close(fd_);
+}
+
+void FileSink::release_locked() {
+    flush_direct_locked();
+    struct stat st{};
+    if (allocated_ > offset_ && ::fstat(fd_, &st) == 0) {
+        // Release the unused tail of the last preallocated chunk.
+        (void) ::ftruncate(fd_, st.st_size);
     }
 }
 
+bool FileSink::open_locked() {
+    if (fd_ >= 0) {
+        release_locked();
+        if (direct_ && block_fill_ > block_synced_) {
+            // The tail flush failed; carry the staged records over to the reopened file.
+            carry_.append(block_.get() + block_synced_, block_fill_ - block_synced_);
+        }
+        ::close(fd_);
+        fd_ = -1;
+    }
+    direct_ = false;
+    int direct_errno = 0;
+#ifdef O_DIRECT
+    if (options_.direct_io) {
+        fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_DIRECT | O_CLOEXEC, 0644);
+        if (fd_ >= 0 && init_direct_locked()) {
+            direct_ = true;
+        } else {
+            direct_errno = errno;
+            if (fd_ >= 0) {
+                ::close(fd_);
+            }
+        }
+    }
+#endif
+    if (!direct_) {
+        fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    }
+    emergency_fds_changed();
+    if (fd_ < 0) {
+        fail_locked(errno, "Failed to open log file");
+        return false;
+    }
+    if (options_.direct_io && !direct_) {
+        std::cerr << "Direct I/O unavailable for log file " << path_ << " (" << std::strerror(direct_errno)
+                  << "), using buffered writes" << std::endl;
+        options_.direct_io = false;
+    }
+    struct stat st{};
+    offset_ = ::fstat(fd_, &st) == 0 ? static_cast<std::uint64_t>(st.st_size) : 0;
+    allocated_ = offset_;
+    flushing_from_ = offset_;
+    dirty_from_ = offset_;
+    last_errno_ = 0;
+    healthy_.store(true, std::memory_order_release);
+    if (!carry_.empty()) {
+        const std::string carry = std::move(carry_);
+        carry_.clear();
+        return direct_ ? write_direct_locked(carry) : write_buffered_tail_locked(carry);
+    }
+    return true;
+}
+
+void FileSink::reserve_locked(std::size_t len) {
+#ifdef __linux__
+    if (options_.preallocate_bytes == 0 || offset_ + len <= allocated_) {
+        return;
+    }
+    const std::uint64_t chunk = options_.preallocate_bytes;
+    const std::uint64_t end = ((offset_ + len + chunk - 1) / chunk) * chunk;
+    if (::fallocate(fd_, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(allocated_),
+                    static_cast<off_t>(end - allocated_)) == 0) {
+        allocated_ = end;
+        stats_.preallocations += 1;
+    } else if (errno == EOPNOTSUPP || errno == ENOSYS) {
+        options_.preallocate_bytes = 0;
+    }
+#else
+    (void) len;
+#endif
+}
+
+void FileSink::writeback_locked() {
+#ifdef __linux__
+    if (options_.writeback_bytes == 0 || offset_ - dirty_from_ < options_.writeback_bytes) {
+        return;
+    }
+    // Kick off asynchronous writeback of the new window, then wait for the window
+    // submitted last time. At most two windows are ever dirty.
+    ::sync_file_range(fd_, static_cast<off_t>(dirty_from_), static_cast<off_t>(offset_ - dirty_from_),
+                      SYNC_FILE_RANGE_WRITE);
+    stats_.writeback_windows += 1;
+    if (dirty_from_ > flushing_from_) {
+        const auto from = static_cast<off_t>(flushing_from_);
+        const auto len = static_cast<off_t>(dirty_from_ - flushing_from_);
+        ::sync_file_range(fd_, from, len,
+                          SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+        if (options_.drop_cache) {
+            ::posix_fadvise(fd_, from, len, POSIX_FADV_DONTNEED);
+        }
+    }
+    flushing_from_ = dirty_from_;
+    dirty_from_ = offset_;
+#endif
+}
+
+void FileSink::fail_locked(int err, const char *what) {
+    // Report only the transition to unhealthy, not every dropped record.
+    if (healthy_.exchange(false, std::memory_order_acq_rel) || last_errno_ != err) {
+        std::cerr << what << ": " << path_ << ": " << std::strerror(err) << std::endl;
+    }
+    last_errno_ = err;
+}
+
 void FileSink::write(const Record& r, std::string_view formatted) {
-    std::lock_guard lock(m_);
-    if (!out_.is_open()) {
+    std::unique_lock lock(m_);
+    if (fd_ < 0) {
+        healthy_.store(false, std::memory_order_release);
+        return;
+    }
+    reserve_locked(formatted.size() + 1);
+    if (direct_) {
+        const std::uint64_t base = block_base_;
+        const std::size_t fill = block_fill_;
+        if (!write_direct_locked(formatted) || !write_direct_locked("\n")) {
+            // Do not leave a partial record staged in front of the next one.
+            if (direct_ && block_base_ == base) {
+                block_fill_ = fill;
+            } else if (direct_) {
+                block_fill_ = block_synced_ = 0;
+            }
+            return;
+        }
+        // Error records should not wait in memory for the block to fill.
+        if (r.level >= LogLevel::error && !flush_direct_locked()) {
+            return;
+        }
+    } else {
+        if (!write_buffered_locked(formatted)) {
+            return;
+        }
+        writeback_locked();
+    }
+    if (options_.durable) {
+        commit_locked(lock, ++written_seq_);
+    }
+}
+
+void FileSink::write_batch(std::span<const FormattedRecord> batch) {
+    if (batch.empty()) {
+        return;
+    }
+    if (batch.size() == 1) {
+        write(batch.front().record, batch.front().text);
         return;
     }
-    out_ << formatted << '\n';
-    out_.flush();
+    const FormattedRecord *severest = &batch.front();
+    std::size_t bytes = batch.size() - 1;
+    for (const auto &entry : batch) {
+        bytes += entry.text.size();
+        if (entry.record.level > severest->record.level) {
+            severest = &entry;
+        }
+    }
+    std::string joined;
+    joined.reserve(bytes);
+    for (const auto &entry : batch) {
+        if (&entry != &batch.front()) {
+            joined += '\n';
+        }
+        joined.append(entry.text);
+    }
+    write(severest->record, joined);
+}
+
+bool FileSink::write_buffered_locked(std::string_view formatted) {
+    char newline = '\n';
+    iovec iov[2] = {
+        {const_cast<char *>(formatted.data()), formatted.size()},
+        {&newline, 1}
+    };
+    int iovcnt = 2;
+    iovec *cur = iov;
+    while (iovcnt > 0) {
+        const ssize_t n = ::writev(fd_, cur, iovcnt);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fail_locked(errno, "Failed to write log file");
+            return false;
+        }
+        offset_ += static_cast<std::uint64_t>(n);
+        auto left = static_cast<std::size_t>(n);
+        while (iovcnt > 0 && left >= cur->iov_len) {
+            left -= cur->iov_len;
+            ++cur;
+            --iovcnt;
+        }
+        if (iovcnt > 0) {
+            cur->iov_base = static_cast<char *>(cur->iov_base) + left;
+            cur->iov_len -= left;
+        }
+    }
+    return true;
+}
+
+bool FileSink::init_direct_locked() {
+    if (!block_) {
+        block_size_ = align_up(std::max(options_.direct_block_bytes, DIRECT_ALIGN));
+        void *mem = nullptr;
+        if (::posix_memalign(&mem, DIRECT_ALIGN, block_size_) != 0) {
+            errno = ENOMEM;
+            return false;
+        }
+        block_.reset(static_cast<char *>(mem));
+    }
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0) {
+        return false;
+    }
+    // Resume inside the last partial block: it is rewritten in place on the next flush.
+    const auto size = static_cast<std::uint64_t>(st.st_size);
+    block_base_ = size & ~static_cast<std::uint64_t>(DIRECT_ALIGN - 1);
+    block_fill_ = static_cast<std::size_t>(size - block_base_);
+    block_synced_ = block_fill_;
+    if (block_fill_ > 0) {
+        const ssize_t n = ::pread(fd_, block_.get(), DIRECT_ALIGN, static_cast<off_t>(block_base_));
+        if (n < static_cast<ssize_t>(block_fill_)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FileSink::write_direct_locked(std::string_view data) {
+    while (!data.empty()) {
+        const std::size_t take = std::min(data.size(), block_size_ - block_fill_);
+        std::memcpy(block_.get() + block_fill_, data.data(), take);
+        block_fill_ += take;
+        data.remove_prefix(take);
+        if (block_fill_ < block_size_) {
+            break;
+        }
+        if (!write_block_locked(block_size_)) {
+            // A fallback already wrote the block through the page cache.
+            return !direct_ && fd_ >= 0 && (data.empty() || write_buffered_tail_locked(data));
+        }
+        block_base_ += block_size_;
+        block_fill_ = 0;
+        block_synced_ = 0;
+    }
+    offset_ = block_base_ + block_fill_;
+    return true;
+}
+
+bool FileSink::write_buffered_tail_locked(std::string_view data) {
+    while (!data.empty()) {
+        const ssize_t n = ::write(fd_, data.data(), data.size());
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fail_locked(errno, "Failed to write log file");
+            return false;
+        }
+        offset_ += static_cast<std::uint64_t>(n);
+        data.remove_prefix(static_cast<std::size_t>(n));
+    }
+    return true;
+}
+
+bool FileSink::write_block_locked(std::size_t len) {
+    std::size_t done = 0;
+    while (done < len) {
+        const ssize_t n = ::pwrite(fd_, block_.get() + done, len - done,
+                                   static_cast<off_t>(block_base_ + done));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EINVAL) {
+                fall_back_to_buffered_locked();
+                return false;
+            }
+            fail_locked(errno, "Failed to write log file");
+            return false;
+        }
+        done += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool FileSink::flush_direct_locked() {
+    if (!direct_ || block_fill_ == 0 || fd_ < 0) {
+        return true;
+    }
+    const std::size_t padded = align_up(block_fill_);
+    std::memset(block_.get() + block_fill_, 0, padded - block_fill_);
+    if (!write_block_locked(padded)) {
+        return !direct_ && fd_ >= 0;
+    }
+    if (::ftruncate(fd_, static_cast<off_t>(block_base_ + block_fill_)) != 0) {
+        fail_locked(errno, "Failed to trim log file");
+        return false;
+    }
+    // Whole aligned blocks are final on disk; keep only the partial one in memory.
+    const std::size_t settled = block_fill_ & ~(DIRECT_ALIGN - 1);
+    if (settled > 0) {
+        std::memmove(block_.get(), block_.get() + settled, block_fill_ - settled);
+        block_base_ += settled;
+        block_fill_ -= settled;
+    }
+    block_synced_ = block_fill_;
+    return true;
+}
+
+bool FileSink::fall_back_to_buffered_locked() {
+    std::cerr << "Direct I/O rejected for log file " << path_ << ", using buffered writes" << std::endl;
+    const std::uint64_t base = block_base_;
+    const std::size_t fill = block_fill_;
+    ::close(fd_);
+    direct_ = false;
+    options_.direct_io = false;
+    block_fill_ = 0;
+    block_synced_ = 0;
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    emergency_fds_changed();
+    if (fd_ < 0) {
+        fail_locked(errno, "Failed to open log file");
+        return false;
+    }
+    // Drop any padding left by an earlier tail flush, then replay the staged bytes.
+    if (::ftruncate(fd_, static_cast<off_t>(base)) != 0) {
+        fail_locked(errno, "Failed to trim log file");
+        return false;
+    }
+    offset_ = base;
+    dirty_from_ = flushing_from_ = base;
+    return write_buffered_tail_locked({block_.get(), fill});
+}
+
+void FileSink::flush() {
+    std::lock_guard lock(m_);
+    flush_direct_locked();
+}
+
+void FileSink::commit_locked(std::unique_lock<std::mutex> &lock, std::uint64_t ticket) {
+    using clock = std::chrono::steady_clock;
+    commit_cv_.notify_all();
+    while (synced_seq_ < ticket && failed_seq_ < ticket) {
+        if (committing_) {
+            commit_cv_.wait_for(lock, std::chrono::milliseconds{100});
+            continue;
+        }
+        committing_ = true;
+        if (options_.commit_max_wait.count() > 0) {
+            commit_cv_.wait_for(lock, options_.commit_max_wait, [this] {
+                return options_.commit_group_size > 0 &&
+                       written_seq_ - synced_seq_ >= options_.commit_group_size;
+            });
+        }
+        // Writers keep appending while the sync runs; they form the next group.
+        flush_direct_locked();
+        const std::uint64_t target = written_seq_;
+        // Sync through a private duplicate: reopen() or probe() may close fd_ (and the
+        // number may be reused) while the lock is released.
+        const int fd = fd_ >= 0 ? ::fcntl(fd_, F_DUPFD_CLOEXEC, 0) : -1;
+        int err = fd >= 0 ? 0 : (fd_ >= 0 ? errno : EBADF);
+        lock.unlock();
+        const auto start = clock::now();
+        if (fd >= 0) {
+            if (::fdatasync(fd) != 0) {
+                err = errno;
+            }
+            ::close(fd);
+        }
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+        lock.lock();
+
+        const std::uint64_t group = target - std::max(synced_seq_, failed_seq_);
+        stats_.commits += 1;
+        stats_.total_commit_latency += elapsed;
+        stats_.max_commit_latency = std::max(stats_.max_commit_latency, elapsed);
+        if (err == 0) {
+            stats_.committed_records += group;
+            stats_.max_group_size = std::max(stats_.max_group_size, group);
+            synced_seq_ = target;
+        } else {
+            // Release the waiters without acknowledging durability; the sink is unhealthy.
+            fail_locked(err, "Failed to sync log file");
+            failed_seq_ = target;
+        }
+        committing_ = false;
+        commit_cv_.notify_all();
+    }
+}
+
+bool FileSink::healthy() const {
+    return healthy_.load(std::memory_order_acquire);
+}
+
+bool FileSink::probe() {
+    std::lock_guard lock(m_);
+    if (healthy_.load(std::memory_order_acquire)) {
+        return true;
+    }
+    if (last_errno_ == ENOSPC && fd_ >= 0) {
+        struct statvfs st{};
+        if (::fstatvfs(fd_, &st) != 0 || st.f_bavail == 0) {
+            return false;
+        }
+    }
+    return open_locked();
+}
+
+bool FileSink::reopen() {
+    std::lock_guard lock(m_);
+    return open_locked();
+}
+
+FileSinkStats FileSink::stats() const {
+    std::lock_guard lock(m_);
+    return stats_;
+}
+
+int FileSink::native_fd() const {
+    std::lock_guard lock(m_);
+    return options_.direct_io ? -1 : fd_;
+}
+
+int FileSink::last_error() const {
+    std::lock_guard lock(m_);
+    return last_errno_;
 }
@@ -0,0 +1,504 @@
+#include "dawg-log/filter.hpp"
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+#include <fmt/core.h>
+
+using namespace DawgLog;
+
+namespace {
+// Tri-state truth values used while evaluating; UNKNOWN stands for a predicate
+// on a message that has not been formatted yet.
+constexpr std::uint8_t F = 0;
+constexpr std::uint8_t T = 1;
+constexpr std::uint8_t UNKNOWN = 2;
+
+std::uint8_t kleene_and(std::uint8_t a, std::uint8_t b) {
+    if (a == F || b == F) {
+        return F;
+    }
+    return (a == T && b == T) ? T : UNKNOWN;
+}
+
+std::uint8_t kleene_or(std::uint8_t a, std::uint8_t b) {
+    if (a == T || b == T) {
+        return T;
+    }
+    return (a == F && b == F) ? F : UNKNOWN;
+}
+
+template<typename V>
+bool compare(V lhs, V rhs, int cmp) {
+    switch (cmp) {
+        case 0: return lhs == rhs;
+        case 1: return lhs != rhs;
+        case 2: return lhs < rhs;
+        case 3: return lhs <= rhs;
+        case 4: return lhs > rhs;
+        default: return lhs >= rhs;
+    }
+}
+
+enum class Tok {
+    END,
+    IDENT,
+    STRING,
+    NUMBER,
+    AND,
+    OR,
+    NOT,
+    EQ,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE,
+    LPAREN,
+    RPAREN,
+    LBRACE,
+    RBRACE,
+    COMMA
+};
+
+struct Token {
+    Tok kind{Tok::END};
+    std::string text;
+    std::size_t pos{0};
+};
+} // namespace
+
+namespace DawgLog {
+/**
+ * @brief Recursive-descent compiler turning a filter expression into postfix bytecode
+ */
+class FilterCompiler {
+public:
+    explicit FilterCompiler(std::string_view src) : src_(src) {
+        advance();
+    }
+
+    Filter compile() {
+        Filter f;
+        f.source_ = std::string(src_);
+        if (cur_.kind == Tok::END) {
+            return f;
+        }
+        out_ = &f;
+        parse_or();
+        expect(Tok::END, "end of expression");
+        return f;
+    }
+
+private:
+    using Op = Filter::Op;
+    using Field = Filter::Field;
+    using Cmp = Filter::Cmp;
+
+    [[noreturn]] void fail(const std::string &what) const {
+        throw std::invalid_argument(
+            fmt::format("invalid filter expression '{}': {} at position {}", src_, what, cur_.pos));
+    }
+
+    void advance() {
+        while (pos_ < src_.size() && std::isspace(static_cast<unsigned char>(src_[pos_]))) {
+            ++pos_;
+        }
+        cur_ = Token{};
+        cur_.pos = pos_;
+        if (pos_ >= src_.size()) {
+            return;
+        }
+        const char c = src_[pos_];
+        const auto two = [&](char next) { return pos_ + 1 < src_.size() && src_[pos_ + 1] == next; };
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            const std::size_t start = pos_;
+            while (pos_ < src_.size() && (std::isalnum(static_cast<unsigned char>(src_[pos_])) ||
+                                          src_[pos_] == '_' || src_[pos_] == '.')) {
+                ++pos_;
+            }
+            cur_.kind = Tok::IDENT;
+            cur_.text = std::string(src_.substr(start, pos_ - start));
+            return;
+        }
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            const std::size_t start = pos_;
+            while (pos_ < src_.size() && std::isdigit(static_cast<unsigned char>(src_[pos_]))) {
+                ++pos_;
+            }
+            cur_.kind = Tok::NUMBER;
+            cur_.text = std::string(src_.substr(start, pos_ - start));
+            return;
+        }
+        if (c == '"') {
+            ++pos_;
+            while (pos_ < src_.size() && src_[pos_] != '"') {
+                if (src_[pos_] == '\\' && pos_ + 1 < src_.size()) {
+                    ++pos_;
+                }
+                cur_.text.push_back(src_[pos_++]);
+            }
+            if (pos_ >= src_.size()) {
+                fail("unterminated string");
+            }
+            ++pos_;
+            cur_.kind = Tok::STRING;
+            return;
+        }
+        std::size_t len = 1;
+        switch (c) {
+            case '&':
+                if (!two('&')) {
+                    fail("expected '&&'");
+                }
+                cur_.kind = Tok::AND;
+                len = 2;
+                break;
+            case '|':
+                if (!two('|')) {
+                    fail("expected '||'");
+                }
+                cur_.kind = Tok::OR;
+                len = 2;
+                break;
+            case '!':
+                cur_.kind = two('=') ? Tok::NE : Tok::NOT;
+                len = two('=') ? 2 : 1;
+                break;
+            case '=':
+                if (!two('=')) {
+                    fail("expected '=='");
+                }
+                cur_.kind = Tok::EQ;
+                len = 2;
+                break;
+            case '<':
+                cur_.kind = two('=') ? Tok::LE : Tok::LT;
+                len = two('=') ? 2 : 1;
+                break;
+            case '>':
+                cur_.kind = two('=') ? Tok::GE : Tok::GT;
+                len = two('=') ? 2 : 1;
+                break;
+            case '(': cur_.kind = Tok::LPAREN; break;
+            case ')': cur_.kind = Tok::RPAREN; break;
+            case '{': cur_.kind = Tok::LBRACE; break;
+            case '}': cur_.kind = Tok::RBRACE; break;
+            case ',': cur_.kind = Tok::COMMA; break;
+            default:
+                fail(fmt::format("unexpected character '{}'", c));
+        }
+        pos_ += len;
+    }
+
+    void expect(Tok kind, const char *what) {
+        if (cur_.kind != kind) {
+            fail(fmt::format("expected {}", what));
+        }
+        advance();
+    }
+
+    void emit(Op op, Field field = Field::TAG, Cmp cmp = Cmp::EQ, std::int32_t arg = 0,
+              std::uint32_t count = 0) {
+        out_->code_.push_back(Filter::Instr{op, field, cmp, arg, count});
+        switch (op) {
+            case Op::NOT:
+                break;
+            case Op::AND:
+            case Op::OR:
+                --depth_;
+                break;
+            default:
+                if (++depth_ > Filter::MAX_DEPTH) {
+                    fail("expression nested too deeply");
+                }
+        }
+    }
+
+    std::int32_t intern(std::string s) {
+        out_->strings_.push_back(std::move(s));
+        return static_cast<std::int32_t>(out_->strings_.size() - 1);
+    }
+
+    void parse_or() {
+        parse_and();
+        while (cur_.kind == Tok::OR) {
+            advance();
+            parse_and();
+            emit(Op::OR);
+        }
+    }
+
+    void parse_and() {
+        parse_unary();
+        while (cur_.kind == Tok::AND) {
+            advance();
+            parse_unary();
+            emit(Op::AND);
+        }
+    }
+
+    void parse_unary() {
+        if (cur_.kind == Tok::NOT || cur_.kind == Tok::LPAREN) {
+            // Bound the recursion; '!' and '(' nest without growing the evaluation stack.
+            if (++nesting_ > Filter::MAX_NESTING) {
+                fail("expression nested too deeply");
+            }
+            if (cur_.kind == Tok::NOT) {
+                advance();
+                parse_unary();
+                emit(Op::NOT);
+            } else {
+                advance();
+                parse_or();
+                expect(Tok::RPAREN, "')'");
+            }
+            --nesting_;
+            return;
+        }
+        parse_predicate();
+    }
+
+    bool parse_cmp(Cmp &cmp) {
+        switch (cur_.kind) {
+            case Tok::EQ: cmp = Cmp::EQ; break;
+            case Tok::NE: cmp = Cmp::NE; break;
+            case Tok::LT: cmp = Cmp::LT; break;
+            case Tok::LE: cmp = Cmp::LE; break;
+            case Tok::GT: cmp = Cmp::GT; break;
+            case Tok::GE: cmp = Cmp::GE; break;
+            default: return false;
+        }
+        advance();
+        return true;
+    }
+
+    static bool parse_field(std::string_view name, Field &field) {
+        if (name == "tag") {
+            field = Field::TAG;
+        } else if (name == "file") {
+            field = Field::FILE;
+        } else if (name == "func") {
+            field = Field::FUNC;
+        } else if (name == "message") {
+            field = Field::MESSAGE;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    std::string parse_word() {
+        if (cur_.kind != Tok::IDENT && cur_.kind != Tok::STRING) {
+            fail("expected a name or string");
+        }
+        std::string text = std::move(cur_.text);
+        advance();
+        return text;
+    }
+
+    void parse_predicate() {
+        if (cur_.kind != Tok::IDENT) {
+            fail("expected a predicate");
+        }
+        const std::string name = cur_.text;
+        advance();
+
+        if (name == "true" || name == "false") {
+            emit(name == "true" ? Op::PUSH_TRUE : Op::PUSH_FALSE);
+            return;
+        }
+
+        Cmp cmp{};
+        if (name == "level") {
+            if (!parse_cmp(cmp)) {
+                fail("expected a comparison after 'level'");
+            }
+            const std::string lvl_name = parse_word();
+            LogLevel lvl{};
+            if (!parse_log_level(lvl_name, lvl)) {
+                fail(fmt::format("unknown level '{}'", lvl_name));
+            }
+            emit(Op::LEVEL_CMP, Field::TAG, cmp, static_cast<std::int32_t>(lvl));
+            return;
+        }
+        if (name == "line") {
+            if (!parse_cmp(cmp)) {
+                fail("expected a comparison after 'line'");
+            }
+            if (cur_.kind != Tok::NUMBER) {
+                fail("expected a line number");
+            }
+            std::int32_t line = 0;
+            const char *end = cur_.text.data() + cur_.text.size();
+            const auto [ptr, ec] = std::from_chars(cur_.text.data(), end, line);
+            if (ec != std::errc{} || ptr != end) {
+                fail("line number out of range");
+            }
+            advance();
+            emit(Op::LINE_CMP, Field::TAG, cmp, line);
+            return;
+        }
+
+        Field field{};
+        if (parse_field(name, field)) {
+            if (cur_.kind == Tok::IDENT && cur_.text == "in") {
+                advance();
+                expect(Tok::LBRACE, "'{'");
+                const auto first = static_cast<std::int32_t>(out_->strings_.size());
+                std::uint32_t count = 0;
+                while (cur_.kind != Tok::RBRACE) {
+                    if (count > 0) {
+                        expect(Tok::COMMA, "','");
+                    }
+                    intern(parse_word());
+                    ++count;
+                }
+                advance();
+                emit(Op::STR_IN, field, Cmp::EQ, first, count);
+                return;
+            }
+            if (!parse_cmp(cmp) || (cmp != Cmp::EQ && cmp != Cmp::NE)) {
+                fail(fmt::format("expected '==', '!=' or 'in' after '{}'", name));
+            }
+            emit(Op::STR_EQ, field, cmp, intern(parse_word()));
+            return;
+        }
+
+        const auto underscore = name.rfind('_');
+        if (underscore != std::string::npos && parse_field(name.substr(0, underscore), field)) {
+            const std::string_view fn = std::string_view(name).substr(underscore + 1);
+            if (fn == "prefix" || fn == "contains") {
+                expect(Tok::LPAREN, "'('");
+                if (cur_.kind != Tok::STRING) {
+                    fail("expected a string argument");
+                }
+                const auto arg = intern(parse_word());
+                expect(Tok::RPAREN, "')'");
+                emit(fn == "prefix" ? Op::STR_PREFIX : Op::STR_CONTAINS, field, Cmp::EQ, arg);
+                return;
+            }
+        }
+        fail(fmt::format("unknown predicate '{}'", name));
+    }
+
+    std::string_view src_;
+    std::size_t pos_{0};
+    Token cur_;
+    Filter *out_{nullptr};
+    std::size_t depth_{0};
+    std::size_t nesting_{0};
+};
+} // namespace DawgLog
+
+Filter Filter::compile(std::string_view expr) {
+    return FilterCompiler{expr}.compile();
+}
+
+std::uint8_t Filter::run(LogLevel lvl, std::string_view tag, const SourceLocation &src,
+                         const std::string_view *message) const {
+    std::array<std::uint8_t, MAX_DEPTH> stack{};
+    std::size_t sp = 0;
+
+    const auto field_value = [&](Field field, std::string_view &value) {
+        switch (field) {
+            case Field::TAG: value = tag; return true;
+            case Field::FILE: value = src.file; return true;
+            case Field::FUNC: value = src.func; return true;
+            case Field::MESSAGE:
+                if (message == nullptr) {
+                    return false;
+                }
+                value = *message;
+                return true;
+        }
+        return false;
+    };
+
+    for (const auto &in : code_) {
+        std::string_view value;
+        switch (in.op) {
+            case Op::PUSH_TRUE:
+                stack[sp++] = T;
+                break;
+            case Op::PUSH_FALSE:
+                stack[sp++] = F;
+                break;
+            case Op::LEVEL_CMP:
+                stack[sp++] = compare(static_cast<int>(lvl), in.arg, static_cast<int>(in.cmp)) ? T : F;
+                break;
+            case Op::LINE_CMP:
+                stack[sp++] = compare(src.line, in.arg, static_cast<int>(in.cmp)) ? T : F;
+                break;
+            case Op::STR_EQ:
+                if (!field_value(in.field, value)) {
+                    stack[sp++] = UNKNOWN;
+                    break;
+                }
+                stack[sp++] = ((value == strings_[in.arg]) == (in.cmp == Cmp::EQ)) ? T : F;
+                break;
+            case Op::STR_IN: {
+                if (!field_value(in.field, value)) {
+                    stack[sp++] = UNKNOWN;
+                    break;
+                }
+                std::uint8_t hit = F;
+                for (std::uint32_t i = 0; i < in.count; ++i) {
+                    if (value == strings_[in.arg + i]) {
+                        hit = T;
+                        break;
+                    }
+                }
+                stack[sp++] = hit;
+                break;
+            }
+            case Op::STR_PREFIX:
+                if (!field_value(in.field, value)) {
+                    stack[sp++] = UNKNOWN;
+                    break;
+                }
+                stack[sp++] = value.substr(0, strings_[in.arg].size()) == strings_[in.arg] ? T : F;
+                break;
+            case Op::STR_CONTAINS:
+                if (!field_value(in.field, value)) {
+                    stack[sp++] = UNKNOWN;
+                    break;
+                }
+                stack[sp++] = value.find(strings_[in.arg]) != std::string_view::npos ? T : F;
+                break;
+            case Op::NOT:
+                if (stack[sp - 1] != UNKNOWN) {
+                    stack[sp - 1] = stack[sp - 1] == T ? F : T;
+                }
+                break;
+            case Op::AND:
+                --sp;
+                stack[sp - 1] = kleene_and(stack[sp - 1], stack[sp]);
+                break;
+            case Op::OR:
+                --sp;
+                stack[sp - 1] = kleene_or(stack[sp - 1], stack[sp]);
+                break;
+        }
+    }
+    return sp == 0 ? T : stack[sp - 1];
+}
+
+Filter::Result Filter::evaluate(LogLevel lvl, std::string_view tag, const SourceLocation &src) const {
+    if (code_.empty()) {
+        return Result::ACCEPT;
+    }
+    switch (run(lvl, tag, src, nullptr)) {
+        case F: return Result::REJECT;
+        case T: return Result::ACCEPT;
+        default: return Result::NEEDS_MESSAGE;
+    }
+}
+
+bool Filter::matches(const Record &r) const {
+    if (code_.empty()) {
+        return true;
+    }
+    const std::string_view message{r.message};
+    return run(r.level, r.tag, r.src, &message) == T;
+}
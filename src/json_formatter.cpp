@@ -7,9 +7,34 @@ std::string JsonFormatter::format(const Record& r) {
     nlohmann::json j;
     j["app_name"] = r.app_name;
     j["time"] = r.timestamp;
+    if (r.monotonic) {
+        j["mono_ns"] = r.monotonic->count();
+    }
     j["level"] = std::string(to_string(r.level));
     j["tag"] = r.tag;
     j["message"] = r.message;
+    if (r.seq != 0) {
+        j["seq"] = r.seq;
+        j["thread_id"] = r.thread_id;
+    }
+    if (r.trace.valid()) {
+        char hex[48];
+        hex_encode(r.trace.trace_id.data(), r.trace.trace_id.size(), hex);
+        hex_encode(r.trace.span_id.data(), r.trace.span_id.size(), hex + 32);
+        j["trace_id"] = std::string_view(hex, 32);
+        j["span_id"] = std::string_view(hex + 32, 16);
+    }
+    if (r.duration) {
+        j["duration_us"] = std::chrono::duration<double, std::micro>(*r.duration).count();
+    }
 
-    return j.dump();
+    std::string out = j.dump();
+    if (r.context && !r.context->json.empty()) {
+        // Splice the pre-encoded members in instead of re-encoding them per record.
+        out.pop_back();
+        out += ",\"context\":{";
+        out += r.context->json;
+        out += "}}";
+    }
+    return out;
 }
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "dawg-log/sinks/level_filter_sink.hpp"
+
+using namespace DawgLog;
+
+LevelFilterSink::LevelFilterSink(SinkPtr inner, const LogLevel min_level)
+    : inner_(std::move(inner)), min_level_(min_level) {}
+
+void LevelFilterSink::write(const Record& r, std::string_view formatted) {
+    if (r.level >= min_level_) {
+        inner_->write(r, formatted);
+    }
+}
+
+void LevelFilterSink::flush() {
+    inner_->flush();
+}
+
+bool LevelFilterSink::healthy() const {
+    return inner_->healthy();
+}
+
+bool LevelFilterSink::probe() {
+    return inner_->probe();
+}
+
+bool LevelFilterSink::reopen() {
+    return inner_->reopen();
+}
+
+int LevelFilterSink::native_fd() const {
+    return inner_->native_fd();
+}
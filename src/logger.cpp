@@ -1,11 +1,23 @@
 #include "dawg-log/base_logger.hpp"
 #include "dawg-log/concepts.hpp"
+#include "dawg-log/emergency.hpp"
 #include "dawg-log/general_logs.hpp"
 #include "dawg-log/sinks/console_sink.hpp"
 #include "dawg-log/sinks/syslog_sink.hpp"
 #include "dawg-log/sinks/file_sink.hpp"
+#include "dawg-log/sinks/async_sink.hpp"
+#include "dawg-log/sinks/buffered_sink.hpp"
+#include "dawg-log/sinks/failover_sink.hpp"
+#include "dawg-log/sinks/level_filter_sink.hpp"
+#include "dawg-log/sinks/rate_limited_sink.hpp"
+#include "dawg-log/sinks/sampled_sink.hpp"
+#include "dawg-log/sinks/trace_sink.hpp"
 #include "dawg-log/formatters/text_formatter.hpp"
 #include "dawg-log/formatters/json_formatter.hpp"
+#include <optional>
+#include <sstream>
+#include <system_error>
+#include <utility>
 
 using namespace DawgLog;
 
@@ -21,12 +33,15 @@ FormatterPtr make_formatter(const FormatterType type) {
     }
 }
 
-SinkPtr make_sink(const SinkType type, const std::string& app_name, const std::string& file_path) {
+SinkPtr make_sink(const SinkType type, const std::string& app_name, const std::string& file_path,
+                  const FileSinkOptions& file_options = {}, const std::size_t syslog_chunk_bytes = 0) {
     switch (type) {
         case SinkType::SYSLOG:
-            return std::make_unique<SyslogSink>(app_name);
+            return std::make_unique<SyslogSink>(app_name, syslog_chunk_bytes);
         case SinkType::FILE:
-            return std::make_unique<FileSink>(file_path);
+            return std::make_unique<FileSink>(file_path, file_options);
+        case SinkType::TRACE:
+            return std::make_unique<TraceSink>(file_path);
         default:
             return std::make_unique<ConsoleSink>(app_name);
     }
@@ -39,16 +54,69 @@ Logger::Target make_target(SinkType sink_type,
     return Logger::Target{make_sink(sink_type, app_name, file_path), make_formatter(formatter_type)};
 }
 
+SinkPtr wrap_sink(SinkPtr sink, SinkType type, const std::vector<Config::WrapConfig>& wraps, FormatterType format) {
+    // Listed outermost first, so the last entry wraps the sink itself.
+    for (auto it = wraps.rbegin(); it != wraps.rend(); ++it) {
+        switch (it->type) {
+            case SinkWrapType::ASYNC:
+                sink = std::make_unique<AsyncSink>(std::move(sink), it->capacity, it->drop_when_full);
+                break;
+            case SinkWrapType::BUFFERED:
+                // Syslog and trace sinks send every record as its own message, so a
+                // batch would only hold records back.
+                if (type == SinkType::SYSLOG || type == SinkType::TRACE) {
+                    std::cerr << "Buffered wrap has no effect on syslog and trace sinks. Ignoring it." << std::endl;
+                    break;
+                }
+                sink = std::make_unique<BufferedSink>(std::move(sink), it->bytes);
+                break;
+            case SinkWrapType::LEVEL_FILTER:
+                sink = std::make_unique<LevelFilterSink>(std::move(sink), it->level);
+                break;
+            case SinkWrapType::SAMPLED:
+                sink = std::make_unique<SampledSink>(std::move(sink), it->rate);
+                break;
+            case SinkWrapType::RATE_LIMITED:
+                sink = std::make_unique<RateLimitedSink>(std::move(sink), it->per_second, it->burst,
+                                                         make_formatter(format));
+                break;
+        }
+    }
+    return sink;
+}
+
+SinkPtr make_sink(const Config::TargetConfig& target, const std::string& app_name) {
+    auto sink = make_sink(target.sink, app_name, target.file_path, target.file_options, target.syslog_chunk_bytes);
+    if (target.fallbacks.empty()) {
+        return wrap_sink(std::move(sink), target.sink, target.wrap, target.format);
+    }
+    std::vector<SinkPtr> fallbacks;
+    fallbacks.reserve(target.fallbacks.size());
+    for (const auto& fallback : target.fallbacks) {
+        fallbacks.push_back(make_sink(fallback.sink, app_name, fallback.file_path));
+    }
+    FailoverOptions options;
+    options.latency_threshold = std::chrono::milliseconds{target.failover_latency_ms};
+    options.probe_interval = std::chrono::milliseconds{target.probe_interval_ms};
+    return wrap_sink(std::make_unique<FailoverSink>(std::move(sink), std::move(fallbacks), options),
+                     target.sink, target.wrap, target.format);
+}
+
 std::vector<Logger::Target> make_targets_from_config(const Config& cfg) {
     std::vector<Logger::Target> targets;
     if (!cfg.targets.empty()) {
         targets.reserve(cfg.targets.size());
         for (const auto& target : cfg.targets) {
-            targets.emplace_back(make_target(target.sink, target.format, cfg.app_name, target.file_path));
+            Logger::Target entry{make_sink(target, cfg.app_name), make_formatter(target.format), target.filter};
+            entry.max_record_bytes = target.max_record_bytes;
+            targets.emplace_back(std::move(entry));
         }
         return targets;
     }
-    targets.emplace_back(make_target(cfg.sink, cfg.format, cfg.app_name, cfg.file_path));
+    targets.emplace_back(Logger::Target{wrap_sink(make_sink(cfg.sink, cfg.app_name, cfg.file_path, {},
+                                                            cfg.syslog_chunk_bytes), cfg.sink, cfg.wrap,
+                                                  cfg.format),
+                                        make_formatter(cfg.format)});
     return targets;
 }
 }
@@ -57,29 +125,62 @@ Logger::Logger(std::vector<Target> targets, std::string app_name)
     : targets_(std::move(targets)), app_name_(std::move(app_name)) {}
 
 void Logger::init(const Config& cfg) {
-    logger = std::make_unique<Logger>(make_targets_from_config(cfg), cfg.app_name);
+    init(cfg, make_targets_from_config(cfg));
 }
 
 void Logger::init(const Config& cfg, FormatterPtr formatter) {
     std::vector<Target> targets;
     targets.emplace_back(Target{make_sink(cfg.sink, cfg.app_name, cfg.file_path), std::move(formatter)});
-    logger = std::make_unique<Logger>(std::move(targets), cfg.app_name);
+    init(cfg, std::move(targets));
 }
 
 void Logger::init(const Config& cfg, SinkPtr sink) {
     std::vector<Target> targets;
     targets.emplace_back(Target{std::move(sink), make_formatter(cfg.format)});
-    logger = std::make_unique<Logger>(std::move(targets), cfg.app_name);
+    init(cfg, std::move(targets));
 }
 
 void Logger::init(const Config& cfg, SinkPtr sink, FormatterPtr formatter) {
     std::vector<Target> targets;
     targets.emplace_back(Target{std::move(sink), std::move(formatter)});
-    logger = std::make_unique<Logger>(std::move(targets), cfg.app_name);
+    init(cfg, std::move(targets));
 }
 
 void Logger::init(const Config& cfg, std::vector<Target> targets) {
+    set_clock_source(cfg.clock);
+    set_monotonic_timestamps(cfg.monotonic_timestamps);
+    set_sequence_mode(cfg.sequence);
+    // Keep the old targets open until emergency() has been pointed at the new ones.
+    const auto previous = std::move(logger);
+    if (previous) {
+        // Only one capture can own fds 1 and 2, and only one server can own the
+        // control socket path; release both before the new logger claims them.
+        previous->capture_.reset();
+        previous->control_.reset();
+    }
     logger = std::make_unique<Logger>(std::move(targets), cfg.app_name);
+    set_emergency_app_name(cfg.app_name);
+    {
+        std::shared_lock<std::shared_mutex> lock(logger->m_);
+        logger->publish_emergency_fds_locked();
+    }
+    logger->filter_ = cfg.filter;
+    logger->set_level(cfg.level);
+    logger->enable_backtrace(cfg.backtrace);
+    logger->request_sampling_ = cfg.request_sampling;
+    logger->enable_metrics(cfg.metrics);
+    logger->enable_profiling(cfg.profile);
+    logger->set_overload_protection(cfg.overload);
+    logger->set_max_message_bytes(cfg.max_message_bytes);
+    if (!cfg.metrics_file.empty()) {
+        logger->set_metrics_file(cfg.metrics_file, std::chrono::milliseconds{cfg.metrics_interval_ms});
+    }
+    if (!cfg.control_socket.empty()) {
+        logger->set_control_socket(cfg.control_socket);
+    }
+    if (cfg.capture_stdio.enabled) {
+        logger->set_stdio_capture(cfg.capture_stdio);
+    }
 }
 
 Logger& Logger::instance() {
@@ -87,13 +188,15 @@ Logger& Logger::instance() {
         std::vector<Target> targets;
         targets.emplace_back(make_target(SinkType::CONSOLE, FormatterType::TEXT, "DawgLog", "dawglog.log"));
         logger = std::make_unique<Logger>(std::move(targets), "DawgLog");
+        set_emergency_app_name("DawgLog");
+        logger->publish_emergency_fds_locked();
         WARNING("Logger not initialized. Defaulting to console sink and text format.");
     }
     return *logger;
 }
 
 void Logger::set_formatter(FormatterPtr fmt) {
-    std::lock_guard<std::mutex> lock(m_);
+    std::unique_lock<std::shared_mutex> lock(m_);
     if (targets_.empty()) {
         return;
     }
@@ -101,19 +204,461 @@ void Logger::set_formatter(FormatterPtr fmt) {
 }
 
 void Logger::set_sink(SinkPtr sink) {
-    std::lock_guard<std::mutex> lock(m_);
+    std::unique_lock<std::shared_mutex> lock(m_);
     if (targets_.empty()) {
         return;
     }
-    targets_.front().sink = std::move(sink);
+    const SinkPtr previous = std::exchange(targets_.front().sink, std::move(sink));
+    publish_emergency_fds_locked();
 }
 
 void Logger::set_targets(std::vector<Target> targets) {
-    std::lock_guard<std::mutex> lock(m_);
-    targets_ = std::move(targets);
+    std::unique_lock<std::shared_mutex> lock(m_);
+    targets_.swap(targets);
+    publish_emergency_fds_locked();
 }
 
 void Logger::add_target(SinkPtr sink, FormatterPtr formatter) {
-    std::lock_guard<std::mutex> lock(m_);
+    std::unique_lock<std::shared_mutex> lock(m_);
     targets_.push_back(Target{std::move(sink), std::move(formatter)});
+    publish_emergency_fds_locked();
+}
+
+void Logger::set_filter(Filter filter) {
+    std::unique_lock<std::shared_mutex> lock(m_);
+    filter_ = std::move(filter);
+}
+
+void Logger::log_span(LogLevel lvl, std::string_view tag, const SourceLocation& src, std::string_view name,
+                      std::chrono::nanoseconds duration) {
+    if (metrics_enabled_.load(std::memory_order_relaxed)) {
+        metrics_.record(lvl, tag, src);
+    }
+    std::shared_lock<std::shared_mutex> lock(m_);
+    if (lvl < base_threshold(tag, src)) {
+        return;
+    }
+    if (lvl < overload_.floor()) {
+        relax_overload();
+        return;
+    }
+    if (!admits(lvl, tag, src)) {
+        return;
+    }
+    if (auto* request = RequestScope::current()) {
+        auto deferred = DeferredRecord::capture(lvl, tag, src, "{}", name);
+        deferred.duration = duration;
+        request->capture(std::move(deferred));
+        return;
+    }
+    Record rec{lvl, tag, src, app_name_, name};
+    rec.duration = duration;
+    const bool profiling = profiling_.load(std::memory_order_relaxed);
+    const std::uint64_t start = profiling ? read_cycles() : 0;
+    const std::size_t bytes = dispatch_observed(rec);
+    if (profiling) {
+        profile_site(src, bytes, read_cycles() - start);
+    }
+}
+
+void Logger::flush() {
+    std::shared_lock<std::shared_mutex> lock(m_);
+    for (auto& target : targets_) {
+        if (target.sink) {
+            target.sink->flush();
+        }
+    }
+}
+
+void Logger::set_level(LogLevel lvl) {
+    level_.store(lvl, std::memory_order_relaxed);
+}
+
+LogLevel Logger::level() const {
+    return level_.load(std::memory_order_relaxed);
+}
+
+namespace {
+/** True if path ends with file on a path component boundary */
+bool file_matches(std::string_view path, std::string_view file) {
+    if (path.size() < file.size() || path.substr(path.size() - file.size()) != file) {
+        return false;
+    }
+    return path.size() == file.size() || path[path.size() - file.size() - 1] == '/';
+}
+}
+
+void Logger::set_tag_level(std::string_view tag, LogLevel lvl) {
+    std::unique_lock<std::shared_mutex> lock(m_);
+    for (auto& [name, level] : tag_levels_) {
+        if (name == tag) {
+            level = lvl;
+            return;
+        }
+    }
+    tag_levels_.emplace_back(std::string(tag), lvl);
+    has_level_overrides_ = true;
+}
+
+void Logger::clear_tag_level(std::string_view tag) {
+    std::unique_lock<std::shared_mutex> lock(m_);
+    std::erase_if(tag_levels_, [&](const auto& entry) { return entry.first == tag; });
+    has_level_overrides_ = !tag_levels_.empty() || !site_levels_.empty();
+}
+
+void Logger::set_site_level(std::string_view file, int line, LogLevel lvl) {
+    std::unique_lock<std::shared_mutex> lock(m_);
+    for (auto& site : site_levels_) {
+        if (site.file == file && site.line == line) {
+            site.level = lvl;
+            return;
+        }
+    }
+    site_levels_.push_back(SiteLevel{std::string(file), line, lvl});
+    has_level_overrides_ = true;
+}
+
+void Logger::clear_site_level(std::string_view file, int line) {
+    std::unique_lock<std::shared_mutex> lock(m_);
+    std::erase_if(site_levels_, [&](const SiteLevel& site) { return site.file == file && site.line == line; });
+    has_level_overrides_ = !tag_levels_.empty() || !site_levels_.empty();
+}
+
+LogLevel Logger::override_threshold(std::string_view tag, const SourceLocation& src) const {
+    // A site with a line beats a whole-file entry, which beats a tag override.
+    const SiteLevel* file_match = nullptr;
+    for (const auto& site : site_levels_) {
+        if (!file_matches(src.file, site.file)) {
+            continue;
+        }
+        if (site.line == src.line) {
+            return site.level;
+        }
+        if (site.line == 0) {
+            file_match = &site;
+        }
+    }
+    if (file_match) {
+        return file_match->level;
+    }
+    for (const auto& [name, level] : tag_levels_) {
+        if (name == tag) {
+            return level;
+        }
+    }
+    return level_.load(std::memory_order_relaxed);
+}
+
+bool Logger::set_target_level(std::size_t index, LogLevel lvl) {
+    std::unique_lock<std::shared_mutex> lock(m_);
+    if (index >= targets_.size()) {
+        return false;
+    }
+    targets_[index].level = lvl;
+    return true;
+}
+
+void Logger::reopen() {
+    std::shared_lock<std::shared_mutex> lock(m_);
+    for (auto& target : targets_) {
+        if (target.sink) {
+            target.sink->reopen();
+        }
+    }
+    publish_emergency_fds_locked();
+}
+
+void Logger::publish_emergency_fds_locked() const {
+    // Read before the descriptors, so a change made meanwhile is published again.
+    emergency_generation_.store(emergency_fds_generation(), std::memory_order_relaxed);
+    if (this != logger.get()) {
+        return;
+    }
+    int fds[EMERGENCY_MAX_FDS];
+    std::size_t count = 0;
+    for (const auto& target : targets_) {
+        const int fd = target.sink ? target.sink->native_fd() : -1;
+        if (fd >= 0 && count < EMERGENCY_MAX_FDS) {
+            fds[count++] = fd;
+        }
+    }
+    set_emergency_fds(fds, count);
+}
+
+void Logger::enable_backtrace(std::size_t capacity) {
+    std::unique_lock<std::shared_mutex> lock(m_);
+    backtrace_ = capacity == 0 ? nullptr : std::make_unique<BacktraceBuffer>(capacity);
+}
+
+void Logger::dump_backtrace() {
+    std::shared_lock<std::shared_mutex> lock(m_);
+    dump_backtrace_locked();
+}
+
+void Logger::dump_backtrace_locked() {
+    if (!backtrace_) {
+        return;
+    }
+    for (const auto& deferred : backtrace_->drain()) {
+        dispatch(deferred.materialize(app_name_, max_message_bytes_.load(std::memory_order_relaxed)));
+    }
+}
+
+void Logger::emit_deferred(std::vector<DeferredRecord> records, bool dump_backtrace) {
+    std::shared_lock<std::shared_mutex> lock(m_);
+    if (dump_backtrace) {
+        dump_backtrace_locked();
+    }
+    for (const auto& deferred : records) {
+        dispatch(deferred.materialize(app_name_, max_message_bytes_.load(std::memory_order_relaxed)));
+    }
+}
+
+void Logger::set_request_sampling(RequestSamplingOptions options) {
+    std::unique_lock<std::shared_mutex> lock(m_);
+    request_sampling_ = options;
+}
+
+RequestSamplingOptions Logger::request_sampling() const {
+    std::shared_lock<std::shared_mutex> lock(m_);
+    return request_sampling_;
+}
+
+void Logger::enable_metrics(bool enabled) {
+    metrics_enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void Logger::set_metrics_file(const std::string& path, std::chrono::milliseconds interval) {
+    std::unique_lock<std::shared_mutex> lock(m_);
+    metrics_writer_.reset();
+    if (path.empty()) {
+        return;
+    }
+    metrics_enabled_.store(true, std::memory_order_relaxed);
+    metrics_writer_ = std::make_unique<MetricsWriter>(metrics_, path, interval);
+}
+
+std::string Logger::control(std::string_view command) {
+    std::istringstream in{std::string(command)};
+    std::string verb;
+    in >> verb;
+    if (verb == "level") {
+        std::string scope;
+        if (!(in >> scope)) {
+            return to_string(level()) + "\n";
+        }
+        LogLevel lvl{};
+        if (scope == "tag" || scope == "site") {
+            std::string key;
+            std::string value;
+            if (!(in >> key >> value)) {
+                return "error: usage: level " + scope + " NAME LEVEL|reset\n";
+            }
+            const bool reset = value == "reset";
+            if (!reset && !parse_log_level(value, lvl)) {
+                return "error: unknown level '" + value + "'\n";
+            }
+            if (scope == "tag") {
+                reset ? clear_tag_level(key) : set_tag_level(key, lvl);
+                return "ok\n";
+            }
+            int line = 0;
+            const auto colon = key.rfind(':');
+            if (colon != std::string::npos) {
+                try {
+                    line = std::stoi(key.substr(colon + 1));
+                } catch (const std::exception&) {
+                    return "error: bad line in '" + key + "'\n";
+                }
+                key.resize(colon);
+            }
+            reset ? clear_site_level(key, line) : set_site_level(key, line, lvl);
+            return "ok\n";
+        }
+        if (scope == "target") {
+            std::size_t index = 0;
+            std::string value;
+            if (!(in >> index >> value) || !parse_log_level(value, lvl)) {
+                return "error: usage: level target INDEX LEVEL\n";
+            }
+            return set_target_level(index, lvl) ? "ok\n" : "error: no target " + std::to_string(index) + "\n";
+        }
+        if (!parse_log_level(scope, lvl)) {
+            return "error: unknown level '" + scope + "'\n";
+        }
+        set_level(lvl);
+        return "ok\n";
+    }
+    if (verb == "stats") {
+        std::string out = metrics_.prometheus();
+        if (profiling_.load(std::memory_order_relaxed)) {
+            out += profile_report(0);
+        }
+        return out;
+    }
+    if (verb == "profile") {
+        std::string arg;
+        in >> arg;
+        if (arg == "on" || arg == "off") {
+            enable_profiling(arg == "on");
+            return "ok\n";
+        }
+        if (arg == "report") {
+            return profile_report(0);
+        }
+        return "error: usage: profile on|off|report\n";
+    }
+    if (verb == "flush") {
+        flush();
+        return "ok\n";
+    }
+    if (verb == "rotate") {
+        reopen();
+        return "ok\n";
+    }
+    if (verb == "backtrace") {
+        dump_backtrace();
+        return "ok\n";
+    }
+    return "error: unknown command '" + verb + "'\n";
+}
+
+bool Logger::set_control_socket(const std::string& path) {
+    // Replace outside m_: the server thread takes it while running commands.
+    control_.reset();
+    if (path.empty()) {
+        return true;
+    }
+    try {
+        control_ = std::make_unique<ControlServer>(path, [this](std::string_view command) {
+            return control(command);
+        });
+    } catch (const std::system_error& e) {
+        std::cerr << e.what() << ". Control socket disabled." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Logger::set_stdio_capture(const StdioCaptureOptions& options) {
+    // Replace outside m_: the reader thread logs while draining.
+    capture_.reset();
+    if (options.enabled) {
+        try {
+            capture_ = std::make_unique<StdioCapture>([this, options](int stream, std::string_view line) {
+                const SourceLocation src{stream == 1 ? "<stdout>" : "<stderr>", 0, ""};
+                log(stream == 1 ? options.level : options.stderr_level, options.tag, src, "{}", line);
+            });
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << ". Output capture disabled." << std::endl;
+        }
+    }
+    // Console sinks now write to different descriptors.
+    std::shared_lock<std::shared_mutex> lock(m_);
+    publish_emergency_fds_locked();
+    return !options.enabled || capture_ != nullptr;
+}
+
+bool Logger::admits(LogLevel lvl, std::string_view tag, const SourceLocation& src) const {
+    if (filter_.evaluate(lvl, tag, src) == Filter::Result::REJECT) {
+        return false;
+    }
+    for (const auto& target : targets_) {
+        if (target.sink && target.formatter && lvl >= target.level &&
+            target.filter.evaluate(lvl, tag, src) != Filter::Result::REJECT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::size_t Logger::dispatch(const Record& rec) {
+    if (!filter_.matches(rec)) {
+        return 0;
+    }
+    std::size_t bytes = 0;
+    for (auto& target : targets_) {
+        if (!target.sink || !target.formatter || rec.level < target.level || !target.filter.matches(rec)) {
+            continue;
+        }
+        std::optional<Record> truncated;
+        if (target.max_record_bytes != 0 && rec.message.size() > target.max_record_bytes) {
+            truncated.emplace(rec, truncate_message(rec.message, target.max_record_bytes, rec.message.size()));
+        }
+        const Record& out = truncated ? *truncated : rec;
+        const std::string formatted = target.formatter->format(out);
+        bytes += formatted.size();
+        DAWGLOG_PROBE2(sink_write_begin, target.sink.get(), static_cast<int>(rec.level));
+        target.sink->write(out, formatted);
+        DAWGLOG_PROBE2(sink_write_end, target.sink.get(), formatted.size());
+    }
+    // A sink that reopened or failed over during a write has a new descriptor.
+    if (emergency_fds_generation() != emergency_generation_.load(std::memory_order_relaxed)) {
+        publish_emergency_fds_locked();
+    }
+    return bytes;
+}
+
+std::size_t Logger::dispatch_observed(const Record& rec) {
+    if (!overload_.enabled()) {
+        return dispatch(rec);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    overload_.begin();
+    const std::size_t bytes = dispatch(rec);
+    if (overload_.end(std::chrono::steady_clock::now() - start)) {
+        report_overload();
+    }
+    return bytes;
+}
+
+void Logger::relax_overload() {
+    if (overload_.relax()) {
+        report_overload();
+    }
+}
+
+void Logger::report_overload() {
+    const LogLevel floor = overload_.floor();
+    const std::string message =
+        floor == LogLevel::debug
+            ? fmt::format("Logging load recovered (sink latency {} us); all levels enabled again",
+                          overload_.latency().count())
+            : fmt::format("Logging overloaded (sink latency {} us, {} writers in flight); "
+                          "dropping records below {}",
+                          overload_.latency().count(), overload_.inflight_at_change(), to_string(floor));
+    dispatch(Record{LogLevel::warning, "DawgLog", LOG_SRC, app_name_, message});
+}
+
+void Logger::set_max_message_bytes(std::size_t max_bytes) {
+    max_message_bytes_.store(max_bytes, std::memory_order_relaxed);
+}
+
+std::size_t Logger::max_message_bytes() const {
+    return max_message_bytes_.load(std::memory_order_relaxed);
+}
+
+void Logger::set_overload_protection(const OverloadOptions& options) {
+    std::unique_lock<std::shared_mutex> lock(m_);
+    overload_.configure(options);
+}
+
+void Logger::enable_profiling(bool enabled) {
+    profiling_.store(enabled, std::memory_order_relaxed);
+}
+
+std::vector<SiteProfile> Logger::profile() const {
+    return collect_profile(metrics_.sites());
+}
+
+std::string Logger::profile_report(std::size_t top) const {
+    return format_profile(profile(), top);
+}
+
+void Logger::profile_site(const SourceLocation& src, std::size_t bytes, std::uint64_t cycles) {
+    if (auto* site = metrics_.sites().find(src)) {
+        site->profiled.fetch_add(1, std::memory_order_relaxed);
+        site->bytes.fetch_add(bytes, std::memory_order_relaxed);
+        site->cycles.fetch_add(cycles, std::memory_order_relaxed);
+    }
 }
@@ -0,0 +1,322 @@
+#include "dawg-log/metrics.hpp"
+#include "dawg-log/utils.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <system_error>
+
+using namespace DawgLog;
+
+namespace {
+constexpr std::size_t MAX_PROBES = 64;
+
+std::uint64_t mix(std::uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+std::uint64_t hash_tag(std::string_view tag) {
+    std::uint64_t h = 0xcbf29ce484222325ULL;
+    for (const char c : tag) {
+        h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+std::int64_t steady_seconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char *level_name(std::size_t i) {
+    switch (static_cast<LogLevel>(i)) {
+#define X(name, general, str, syslog) case LogLevel::name: return #name;
+        LOG_LEVELS_XMACRO
+#undef X
+    }
+    return "unknown";
+}
+
+std::string escape_label(std::string_view value) {
+    std::string out;
+    out.reserve(value.size());
+    for (const char c : value) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"': out += "\\\""; break;
+            case '\n': out += "\\n"; break;
+            default: out += c;
+        }
+    }
+    return out;
+}
+}
+
+SiteRegistry::SiteRegistry() : sites_(std::make_unique<Site[]>(CAPACITY)) {}
+
+SiteRegistry::Site *SiteRegistry::find(const SourceLocation &src) {
+    const std::uint64_t key = mix(reinterpret_cast<std::uintptr_t>(src.file) ^
+                                  (static_cast<std::uint64_t>(src.line) << 48)) | 1;
+    std::size_t idx = key & (CAPACITY - 1);
+    for (std::size_t probe = 0; probe < MAX_PROBES; ++probe, idx = (idx + 1) & (CAPACITY - 1)) {
+        Site &site = sites_[idx];
+        std::uint64_t current = site.key.load(std::memory_order_acquire);
+        if (current == 0) {
+            if (site.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+                site.file = src.file;
+                site.line = src.line;
+                site.func = src.func;
+                site.ready.store(true, std::memory_order_release);
+                return &site;
+            }
+        }
+        if (current == key) {
+            while (!site.ready.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            if (site.file == src.file && site.line == src.line) {
+                return &site;
+            }
+        }
+    }
+    return nullptr;
+}
+
+Metrics::Metrics() : tags_(std::make_unique<Tag[]>(MAX_TAGS)) {}
+
+Metrics::~Metrics() {
+    delete[] counts_.load(std::memory_order_relaxed);
+}
+
+Metrics::ShardCounts *Metrics::counts() {
+    ShardCounts *current = counts_.load(std::memory_order_acquire);
+    if (current != nullptr) {
+        return current;
+    }
+    auto *fresh = new ShardCounts[SHARDS];
+    if (counts_.compare_exchange_strong(current, fresh, std::memory_order_acq_rel)) {
+        return fresh;
+    }
+    delete[] fresh;
+    return current;
+}
+
+std::size_t Metrics::find_tag(std::string_view tag) {
+    const std::uint64_t key = hash_tag(tag) | 1;
+    std::size_t idx = key & (MAX_TAGS - 1);
+    for (std::size_t probe = 0; probe < MAX_PROBES; ++probe, idx = (idx + 1) & (MAX_TAGS - 1)) {
+        Tag &entry = tags_[idx];
+        std::uint64_t current = entry.key.load(std::memory_order_acquire);
+        if (current == 0 && entry.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+            entry.name = std::string(tag);
+            entry.ready.store(true, std::memory_order_release);
+            return idx;
+        }
+        if (current == key) {
+            while (!entry.ready.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            if (entry.name == tag) {
+                return idx;
+            }
+        }
+    }
+    return MAX_TAGS;
+}
+
+void Metrics::record(LogLevel lvl, std::string_view tag, const SourceLocation &src) {
+    const std::size_t shard = current_thread_id() % SHARDS;
+    shards_[shard].levels[static_cast<std::size_t>(lvl)].fetch_add(1, std::memory_order_relaxed);
+
+    ShardCounts &local = counts()[shard];
+    auto *site = sites_.find(src);
+    std::size_t slot = MAX_TAGS;
+    if (site != nullptr) {
+        local.sites[sites_.index(*site)].fetch_add(1, std::memory_order_relaxed);
+        // A call site almost always logs the same tag; only a length check and a
+        // short compare stand between it and the cached slot.
+        const std::uint32_t cached = site->tag.load(std::memory_order_acquire);
+        if (cached != 0 && tags_[cached - 1].name == tag) {
+            slot = cached - 1;
+        }
+    }
+    if (slot == MAX_TAGS) {
+        slot = find_tag(tag);
+        if (site != nullptr && slot != MAX_TAGS) {
+            std::uint32_t unset = 0;
+            site->tag.compare_exchange_strong(unset, static_cast<std::uint32_t>(slot + 1),
+                                              std::memory_order_release, std::memory_order_relaxed);
+        }
+    }
+    if (slot != MAX_TAGS) {
+        local.tags[slot].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (lvl >= LogLevel::error) {
+        const std::int64_t now = steady_seconds();
+        auto &bucket = errors_[static_cast<std::size_t>(now) % WINDOW_SECONDS];
+        const std::uint64_t stamp = static_cast<std::uint64_t>(now + 1) << 32;
+        std::uint64_t word = bucket.load(std::memory_order_relaxed);
+        // Second and count change together, so recycling the bucket left from a
+        // minute ago cannot discard errors another thread counted this second.
+        std::uint64_t next;
+        do {
+            next = (word & ~0xffffffffULL) == stamp ? word + 1 : stamp | 1;
+        } while (!bucket.compare_exchange_weak(word, next, std::memory_order_relaxed));
+    }
+}
+
+std::uint64_t Metrics::level_count(LogLevel lvl) const {
+    std::uint64_t total = 0;
+    for (const auto &shard : shards_) {
+        total += shard.levels[static_cast<std::size_t>(lvl)].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::uint64_t Metrics::tag_total(std::size_t slot) const {
+    const ShardCounts *shards = counts_.load(std::memory_order_acquire);
+    if (shards == nullptr) {
+        return 0;
+    }
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < SHARDS; ++i) {
+        total += shards[i].tags[slot].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::uint64_t Metrics::tag_count(std::string_view tag) const {
+    for (std::size_t i = 0; i < MAX_TAGS; ++i) {
+        if (tags_[i].ready.load(std::memory_order_acquire) && tags_[i].name == tag) {
+            return tag_total(i);
+        }
+    }
+    return 0;
+}
+
+std::vector<std::pair<std::string, std::uint64_t>> Metrics::tag_counts() const {
+    std::vector<std::pair<std::string, std::uint64_t>> out;
+    for (std::size_t i = 0; i < MAX_TAGS; ++i) {
+        if (tags_[i].ready.load(std::memory_order_acquire)) {
+            out.emplace_back(tags_[i].name, tag_total(i));
+        }
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+std::vector<SiteCount> Metrics::site_counts() const {
+    // The same file:line can appear more than once when a header is compiled into
+    // several translation units, each with its own __FILE__ literal.
+    const ShardCounts *shards = counts_.load(std::memory_order_acquire);
+    std::map<std::pair<std::string, int>, SiteCount> merged;
+    sites_.for_each([&](const SiteRegistry::Site &site) {
+        auto &entry = merged[{site.file, site.line}];
+        entry.file = site.file;
+        entry.line = site.line;
+        entry.func = site.func;
+        for (std::size_t i = 0; shards != nullptr && i < SHARDS; ++i) {
+            entry.count += shards[i].sites[sites_.index(site)].load(std::memory_order_relaxed);
+        }
+    });
+    std::vector<SiteCount> out;
+    out.reserve(merged.size());
+    for (auto &[key, entry] : merged) {
+        out.push_back(std::move(entry));
+    }
+    std::stable_sort(out.begin(), out.end(), [](const SiteCount &a, const SiteCount &b) {
+        return a.count > b.count;
+    });
+    return out;
+}
+
+double Metrics::error_rate(std::chrono::seconds window) const {
+    const auto span = std::clamp<std::int64_t>(window.count(), 1, WINDOW_SECONDS);
+    const std::int64_t now = steady_seconds();
+    std::uint64_t total = 0;
+    for (const auto &bucket : errors_) {
+        const std::uint64_t word = bucket.load(std::memory_order_relaxed);
+        const auto second = static_cast<std::int64_t>(word >> 32) - 1;
+        if (second >= 0 && now - second < span) {
+            total += word & 0xffffffffULL;
+        }
+    }
+    return static_cast<double>(total) / static_cast<double>(span);
+}
+
+std::string Metrics::prometheus() const {
+    std::string out;
+    out += "# HELP dawglog_records_total Log calls by level, counted before level and filter checks.\n";
+    out += "# TYPE dawglog_records_total counter\n";
+    for (std::size_t i = 0; i < LOG_LEVEL_COUNT; ++i) {
+        out += "dawglog_records_total{level=\"";
+        out += level_name(i);
+        out += "\"} " + std::to_string(level_count(static_cast<LogLevel>(i))) + "\n";
+    }
+    out += "# HELP dawglog_tag_records_total Log calls by tag.\n";
+    out += "# TYPE dawglog_tag_records_total counter\n";
+    for (const auto &[tag, count] : tag_counts()) {
+        out += "dawglog_tag_records_total{tag=\"" + escape_label(tag) + "\"} " + std::to_string(count) + "\n";
+    }
+    out += "# HELP dawglog_site_records_total Log calls by call site.\n";
+    out += "# TYPE dawglog_site_records_total counter\n";
+    for (const auto &site : site_counts()) {
+        out += "dawglog_site_records_total{file=\"" + escape_label(site.file) + "\",line=\"" +
+               std::to_string(site.line) + "\",func=\"" + escape_label(site.func) + "\"} " +
+               std::to_string(site.count) + "\n";
+    }
+    out += "# HELP dawglog_error_rate Error and critical records per second.\n";
+    out += "# TYPE dawglog_error_rate gauge\n";
+    for (const int window : {10, 60}) {
+        char value[64];
+        std::snprintf(value, sizeof(value), "%g", error_rate(std::chrono::seconds{window}));
+        out += "dawglog_error_rate{window=\"" + std::to_string(window) + "s\"} " + value + "\n";
+    }
+    return out;
+}
+
+MetricsWriter::MetricsWriter(const Metrics &metrics, std::string path, std::chrono::milliseconds interval)
+    : metrics_(metrics), path_(std::move(path)), interval_(interval) {
+    thread_ = std::thread([this] { run(); });
+}
+
+MetricsWriter::~MetricsWriter() {
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+    write();
+}
+
+void MetricsWriter::write() const {
+    const std::string tmp = path_ + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) {
+            std::cerr << "Failed to write metrics file: " << tmp << std::endl;
+            return;
+        }
+        out << metrics_.prometheus();
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path_, ec);
+    if (ec) {
+        std::cerr << "Failed to replace metrics file " << path_ << ": " << ec.message() << std::endl;
+    }
+}
+
+void MetricsWriter::run() {
+    std::unique_lock<std::mutex> lock(m_);
+    while (!cv_.wait_for(lock, interval_, [this] { return stop_; })) {
+        lock.unlock();
+        write();
+        lock.lock();
+    }
+}
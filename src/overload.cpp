@@ -0,0 +1,85 @@
+#include "dawg-log/overload.hpp"
+
+using namespace DawgLog;
+
+namespace {
+/** Weight of a new sample in the moving average is 1 / AVERAGE_WEIGHT */
+constexpr std::int64_t AVERAGE_WEIGHT = 8;
+
+std::int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+void OverloadGuard::configure(const OverloadOptions &options) {
+    options_ = options;
+    floor_.store(LogLevel::debug, std::memory_order_relaxed);
+    average_ns_.store(0, std::memory_order_relaxed);
+    last_change_ns_.store(0, std::memory_order_relaxed);
+    last_sample_ns_.store(0, std::memory_order_relaxed);
+}
+
+std::chrono::microseconds OverloadGuard::latency() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::nanoseconds{average_ns_.load(std::memory_order_relaxed)});
+}
+
+bool OverloadGuard::end(std::chrono::nanoseconds elapsed) {
+    const std::uint32_t inflight = inflight_.fetch_sub(1, std::memory_order_relaxed);
+    // Racing updates may lose a sample; the average only has to follow the trend.
+    std::int64_t average = average_ns_.load(std::memory_order_relaxed);
+    average += (elapsed.count() - average) / AVERAGE_WEIGHT;
+    average_ns_.store(average, std::memory_order_relaxed);
+
+    const std::int64_t now = now_ns();
+    last_sample_ns_.store(now, std::memory_order_relaxed);
+    std::int64_t last = last_change_ns_.load(std::memory_order_relaxed);
+    if (now - last < std::chrono::duration_cast<std::chrono::nanoseconds>(options_.cooldown).count()) {
+        return false;
+    }
+
+    const auto high = std::chrono::duration_cast<std::chrono::nanoseconds>(options_.latency_high).count();
+    const auto low = std::chrono::duration_cast<std::chrono::nanoseconds>(options_.latency_low).count();
+    const bool crowded = options_.max_inflight > 0 && inflight > options_.max_inflight;
+    const bool pressure = average > high || crowded;
+    const bool calm = average < low && (options_.max_inflight == 0 || inflight <= options_.max_inflight / 2);
+
+    const LogLevel current = floor_.load(std::memory_order_relaxed);
+    LogLevel next = current;
+    if (pressure && current < LogLevel::error) {
+        next = static_cast<LogLevel>(static_cast<int>(current) + 1);
+    } else if (calm && current > LogLevel::debug) {
+        next = static_cast<LogLevel>(static_cast<int>(current) - 1);
+    }
+    if (next == current) {
+        return false;
+    }
+    // Only one of the threads racing past the cooldown gets to move the floor.
+    if (!last_change_ns_.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        return false;
+    }
+    inflight_at_change_.store(inflight, std::memory_order_relaxed);
+    floor_.store(next, std::memory_order_relaxed);
+    return true;
+}
+
+bool OverloadGuard::relax() {
+    const LogLevel current = floor_.load(std::memory_order_relaxed);
+    if (current == LogLevel::debug) {
+        return false;
+    }
+    const std::int64_t now = now_ns();
+    const auto cooldown = std::chrono::duration_cast<std::chrono::nanoseconds>(options_.cooldown).count();
+    std::int64_t last = last_change_ns_.load(std::memory_order_relaxed);
+    if (now - last < cooldown || now - last_sample_ns_.load(std::memory_order_relaxed) < cooldown) {
+        return false;
+    }
+    if (!last_change_ns_.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        return false;
+    }
+    average_ns_.store(0, std::memory_order_relaxed);
+    inflight_at_change_.store(inflight_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    floor_.store(static_cast<LogLevel>(static_cast<int>(current) - 1), std::memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,49 @@
+#include "dawg-log/profiler.hpp"
+#include <algorithm>
+#include <map>
+#include <fmt/format.h>
+
+using namespace DawgLog;
+
+std::vector<SiteProfile> DawgLog::collect_profile(const SiteRegistry &sites) {
+    std::map<std::pair<std::string, int>, SiteProfile> merged;
+    sites.for_each([&](const SiteRegistry::Site &site) {
+        const auto calls = site.profiled.load(std::memory_order_relaxed);
+        if (calls == 0) {
+            return;
+        }
+        auto &entry = merged[{site.file, site.line}];
+        entry.file = site.file;
+        entry.line = site.line;
+        entry.func = site.func;
+        entry.calls += calls;
+        entry.bytes += site.bytes.load(std::memory_order_relaxed);
+        entry.cycles += site.cycles.load(std::memory_order_relaxed);
+    });
+    std::vector<SiteProfile> out;
+    out.reserve(merged.size());
+    for (auto &[key, entry] : merged) {
+        out.push_back(std::move(entry));
+    }
+    std::stable_sort(out.begin(), out.end(), [](const SiteProfile &a, const SiteProfile &b) {
+        return a.cycles > b.cycles;
+    });
+    return out;
+}
+
+std::string DawgLog::format_profile(const std::vector<SiteProfile> &profile, std::size_t top) {
+    std::uint64_t total = 0;
+    for (const auto &site : profile) {
+        total += site.cycles;
+    }
+    std::string out = fmt::format("{:>7} {:>10} {:>12} {:>12}  {}\n", "share", "calls", "bytes", "cycles/call",
+                                  "site");
+    const std::size_t rows = top == 0 ? profile.size() : std::min(top, profile.size());
+    for (std::size_t i = 0; i < rows; ++i) {
+        const auto &site = profile[i];
+        const double share = total == 0 ? 0.0 : 100.0 * static_cast<double>(site.cycles) / static_cast<double>(total);
+        fmt::format_to(std::back_inserter(out), "{:>6.2f}% {:>10} {:>12} {:>12}  {}:{} ({})\n", share, site.calls,
+                       site.bytes, site.cycles / site.calls, site.file, site.line, site.func);
+    }
+    return out;
+}
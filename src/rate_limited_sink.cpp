@@ -0,0 +1,55 @@
+#include "dawg-log/sinks/rate_limited_sink.hpp"
+#include <algorithm>
+#include <fmt/core.h>
+
+using namespace DawgLog;
+
+RateLimitedSink::RateLimitedSink(SinkPtr inner, const double per_second, const std::uint32_t burst,
+                                 FormatterPtr formatter)
+    : inner_(std::move(inner)), formatter_(std::move(formatter)), per_second_(per_second), burst_(burst == 0 ? std::max(per_second, 1.0) : burst),
+      tokens_(burst_), last_(std::chrono::steady_clock::now()) {}
+
+void RateLimitedSink::write(const Record& r, std::string_view formatted) {
+    std::lock_guard lock(m_);
+    const auto now = std::chrono::steady_clock::now();
+    tokens_ = std::min(burst_, tokens_ + std::chrono::duration<double>(now - last_).count() * per_second_);
+    last_ = now;
+    if (tokens_ < 1.0) {
+        ++suppressed_;
+        ++dropped_;
+        return;
+    }
+    tokens_ -= 1.0;
+    if (suppressed_ != 0 && formatter_) {
+        Record note{r, fmt::format("Rate limit suppressed {} records", suppressed_)};
+        note.level = LogLevel::warning;
+        inner_->write(note, formatter_->format(note));
+    }
+    suppressed_ = 0;
+    inner_->write(r, formatted);
+}
+
+void RateLimitedSink::flush() {
+    inner_->flush();
+}
+
+bool RateLimitedSink::healthy() const {
+    return inner_->healthy();
+}
+
+bool RateLimitedSink::probe() {
+    return inner_->probe();
+}
+
+bool RateLimitedSink::reopen() {
+    return inner_->reopen();
+}
+
+int RateLimitedSink::native_fd() const {
+    return inner_->native_fd();
+}
+
+std::uint64_t RateLimitedSink::dropped() const {
+    std::lock_guard lock(m_);
+    return dropped_;
+}
@@ -0,0 +1,47 @@
+#include "dawg-log/request_scope.hpp"
+#include "dawg-log/base_logger.hpp"
+
+using namespace DawgLog;
+
+namespace {
+thread_local RequestScope *current_scope = nullptr;
+}
+
+RequestScope::RequestScope(std::string id)
+    : RequestScope(std::move(id), Logger::instance().request_sampling()) {
+}
+
+RequestScope::RequestScope(std::string id, RequestSamplingOptions options)
+    : id_(std::move(id)), options_(options), context_{{"request_id", id_}}, previous_(current_scope),
+      start_(std::chrono::steady_clock::now()), keep_(random_chance(options.sample_rate)) {
+    current_scope = this;
+}
+
+RequestScope::~RequestScope() {
+    current_scope = previous_;
+    const auto elapsed = std::chrono::steady_clock::now() - start_;
+    const bool slow = options_.slow_threshold.count() > 0 && elapsed >= options_.slow_threshold;
+    if (records_.empty() || !(error_ || slow || keep_)) {
+        return;
+    }
+    Logger::instance().emit_deferred(std::move(records_), error_);
+    if (dropped_ > 0) {
+        Logger::instance().log(LogLevel::warning, "DawgLog", LOG_SRC,
+                               "request {}: {} buffered records dropped", id_, dropped_);
+    }
+}
+
+RequestScope *RequestScope::current() {
+    return current_scope;
+}
+
+void RequestScope::capture(DeferredRecord rec) {
+    if (rec.level >= LogLevel::error) {
+        error_ = true;
+    }
+    if (records_.size() >= options_.max_records) {
+        ++dropped_;
+        return;
+    }
+    records_.push_back(std::move(rec));
+}
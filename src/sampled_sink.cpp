@@ -0,0 +1,33 @@
+#include "dawg-log/sinks/sampled_sink.hpp"
+#include "dawg-log/utils.hpp"
+
+using namespace DawgLog;
+
+SampledSink::SampledSink(SinkPtr inner, const double rate)
+    : inner_(std::move(inner)), rate_(rate) {}
+
+void SampledSink::write(const Record& r, std::string_view formatted) {
+    if (r.level >= LogLevel::error || random_chance(rate_)) {
+        inner_->write(r, formatted);
+    }
+}
+
+void SampledSink::flush() {
+    inner_->flush();
+}
+
+bool SampledSink::healthy() const {
+    return inner_->healthy();
+}
+
+bool SampledSink::probe() {
+    return inner_->probe();
+}
+
+bool SampledSink::reopen() {
+    return inner_->reopen();
+}
+
+int SampledSink::native_fd() const {
+    return inner_->native_fd();
+}
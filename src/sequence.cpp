@@ -0,0 +1,50 @@
+#include "dawg-log/sequence.hpp"
+#include <atomic>
+#include <iostream>
+#include <map>
+
+using namespace DawgLog;
+
+namespace {
+std::atomic<SequenceMode> mode{SequenceMode::OFF};
+std::atomic<std::uint64_t> global_counter{0};
+}
+
+void DawgLog::set_sequence_mode(SequenceMode m) {
+    mode.store(m, std::memory_order_relaxed);
+}
+
+SequenceMode DawgLog::sequence_mode() {
+    return mode.load(std::memory_order_relaxed);
+}
+
+std::uint64_t DawgLog::next_sequence() {
+    return next_sequence(mode.load(std::memory_order_relaxed));
+}
+
+std::uint64_t DawgLog::next_sequence(SequenceMode m) {
+    switch (m) {
+        case SequenceMode::THREAD: {
+            thread_local std::uint64_t counter = 0;
+            return ++counter;
+        }
+        case SequenceMode::GLOBAL:
+            return global_counter.fetch_add(1, std::memory_order_relaxed) + 1;
+        default:
+            return 0;
+    }
+}
+
+SequenceMode DawgLog::string_to_sequence_mode(const std::string &name) {
+    static const std::map<std::string, SequenceMode> mapping = {
+        {"off", SequenceMode::OFF},
+        {"thread", SequenceMode::THREAD},
+        {"global", SequenceMode::GLOBAL}
+    };
+    const auto it = mapping.find(name);
+    if (it == mapping.end()) {
+        std::cerr << "Unknown sequence mode '" << name << "'. Falling back to 'off'." << std::endl;
+        return SequenceMode::OFF;
+    }
+    return it->second;
+}
@@ -0,0 +1,182 @@
+#include "dawg-log/stdio_capture.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+using namespace DawgLog;
+
+namespace {
+/** How often the reader checks for shutdown while the pipes are idle */
+constexpr int POLL_MS = 200;
+
+/** Bytes per read(2), and the longest line passed on in one piece */
+constexpr std::size_t READ_BYTES = 64 * 1024;
+
+/** Pipe capacity requested so bursts do not block the writers */
+constexpr int PIPE_BYTES = 1024 * 1024;
+
+std::atomic<int> stdout_fd{STDOUT_FILENO};
+std::atomic<int> stderr_fd{STDERR_FILENO};
+std::atomic<bool> active{false};
+
+/** Held shared by OriginalStdioGuard, exclusively while the descriptors are switched */
+std::shared_mutex fds_mutex;
+
+/** Point original_stdout() and original_stderr() elsewhere once no writer uses the old ones */
+void set_original_fds(int out, int err) {
+    std::unique_lock lock(fds_mutex);
+    stdout_fd.store(out);
+    stderr_fd.store(err);
+}
+
+void flush_stdio() {
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+}
+
+/** Pass every complete line in pending to handler and keep the rest */
+void emit_lines(std::string &pending, int stream, const StdioCapture::Handler &handler, bool all) {
+    std::size_t start = 0;
+    while (true) {
+        const std::size_t end = pending.find('\n', start);
+        if (end == std::string::npos) {
+            break;
+        }
+        std::string_view line(pending.data() + start, end - start);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (!line.empty()) {
+            handler(stream, line);
+        }
+        start = end + 1;
+    }
+    pending.erase(0, start);
+    if (!pending.empty() && (all || pending.size() >= READ_BYTES)) {
+        handler(stream, pending);
+        pending.clear();
+    }
+}
+}
+
+StdioCapture::StdioCapture(Handler handler) : handler_(std::move(handler)) {
+    if (active.exchange(true)) {
+        throw std::logic_error("stdout/stderr are already captured");
+    }
+    int out_pipe[2] = {-1, -1};
+    int err_pipe[2] = {-1, -1};
+    const auto fail = [&](const char *what) {
+        const int err = errno;
+        for (const int fd : {out_pipe[0], out_pipe[1], err_pipe[0], err_pipe[1], saved_out_, saved_err_}) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+        active.store(false);
+        throw std::system_error(err, std::generic_category(), what);
+    };
+    if (::pipe2(out_pipe, O_CLOEXEC) != 0 || ::pipe2(err_pipe, O_CLOEXEC) != 0) {
+        fail("Failed to create capture pipes");
+    }
+    saved_out_ = ::fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, 3);
+    saved_err_ = ::fcntl(STDERR_FILENO, F_DUPFD_CLOEXEC, 3);
+    if (saved_out_ < 0 || saved_err_ < 0) {
+        fail("Failed to save stdout/stderr");
+    }
+#ifdef F_SETPIPE_SZ
+    ::fcntl(out_pipe[1], F_SETPIPE_SZ, PIPE_BYTES);
+    ::fcntl(err_pipe[1], F_SETPIPE_SZ, PIPE_BYTES);
+#endif
+    ::fcntl(out_pipe[0], F_SETFL, ::fcntl(out_pipe[0], F_GETFL) | O_NONBLOCK);
+    ::fcntl(err_pipe[0], F_SETFL, ::fcntl(err_pipe[0], F_GETFL) | O_NONBLOCK);
+
+    flush_stdio();
+    set_original_fds(saved_out_, saved_err_);
+    if (::dup2(out_pipe[1], STDOUT_FILENO) < 0 || ::dup2(err_pipe[1], STDERR_FILENO) < 0) {
+        ::dup2(saved_out_, STDOUT_FILENO);
+        ::dup2(saved_err_, STDERR_FILENO);
+        set_original_fds(STDOUT_FILENO, STDERR_FILENO);
+        fail("Failed to redirect stdout/stderr");
+    }
+    // Fds 1 and 2 now hold the only write ends, so restoring them later means EOF.
+    ::close(out_pipe[1]);
+    ::close(err_pipe[1]);
+    read_out_ = out_pipe[0];
+    read_err_ = err_pipe[0];
+    thread_ = std::thread([this] { run(); });
+}
+
+StdioCapture::~StdioCapture() {
+    flush_stdio();
+    ::dup2(saved_out_, STDOUT_FILENO);
+    ::dup2(saved_err_, STDERR_FILENO);
+    // Writers that still hold a guard finish on the saved descriptors; later ones
+    // see 1 and 2, so nothing uses the saved ones once they are closed below.
+    set_original_fds(STDOUT_FILENO, STDERR_FILENO);
+    stop_.store(true, std::memory_order_relaxed);
+    thread_.join();
+    ::close(saved_out_);
+    ::close(saved_err_);
+    ::close(read_out_);
+    ::close(read_err_);
+    active.store(false);
+}
+
+void StdioCapture::run() {
+    std::string pending[2];
+    bool open[2] = {true, true};
+    std::string chunk(READ_BYTES, '\0');
+    while (open[0] || open[1]) {
+        pollfd pfds[2] = {{open[0] ? read_out_ : -1, POLLIN, 0}, {open[1] ? read_err_ : -1, POLLIN, 0}};
+        const int ready = ::poll(pfds, 2, POLL_MS);
+        if (ready == 0 && stop_.load(std::memory_order_relaxed)) {
+            // A child process still holds a write end; do not wait for it.
+            break;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+        for (int i = 0; i < 2; ++i) {
+            if (pfds[i].revents == 0) {
+                continue;
+            }
+            while (true) {
+                const ssize_t n = ::read(pfds[i].fd, chunk.data(), chunk.size());
+                if (n > 0) {
+                    pending[i].append(chunk.data(), static_cast<std::size_t>(n));
+                    emit_lines(pending[i], i + 1, handler_, false);
+                    continue;
+                }
+                if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+                    open[i] = false;
+                }
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+        }
+    }
+    for (int i = 0; i < 2; ++i) {
+        emit_lines(pending[i], i + 1, handler_, true);
+    }
+}
+
+int DawgLog::original_stdout() {
+    return stdout_fd.load(std::memory_order_relaxed);
+}
+
+int DawgLog::original_stderr() {
+    return stderr_fd.load(std::memory_order_relaxed);
+}
+
+OriginalStdioGuard::OriginalStdioGuard()
+    : lock_(fds_mutex), out_(stdout_fd.load(std::memory_order_relaxed)),
+      err_(stderr_fd.load(std::memory_order_relaxed)) {}
@@ -6,8 +6,8 @@
 
 using namespace DawgLog;
 
-SyslogSink::SyslogSink(std::string app_name)
-    : app_(std::move(app_name)) {
+SyslogSink::SyslogSink(std::string app_name, std::size_t chunk_bytes)
+    : app_(std::move(app_name)), chunk_bytes_(chunk_bytes) {
     openlog(app_.c_str(), LOG_PID | LOG_NDELAY, LOG_USER);
 }
 
@@ -16,5 +16,15 @@ SyslogSink::~SyslogSink() {
 }
 
 void SyslogSink::write(const Record& r, std::string_view formatted) {
-    syslog(to_syslog_level(r.level), "%s", std::string(formatted).c_str());
+    const int priority = to_syslog_level(r.level);
+    if (chunk_bytes_ == 0 || formatted.size() <= chunk_bytes_) {
+        syslog(priority, "%.*s", static_cast<int>(formatted.size()), formatted.data());
+        return;
+    }
+    const auto chunks = split_utf8_chunks(formatted, chunk_bytes_);
+    const auto id = static_cast<unsigned long long>(next_id_.fetch_add(1, std::memory_order_relaxed) + 1);
+    for (std::size_t part = 0; part < chunks.size(); ++part) {
+        syslog(priority, "[%llu %zu/%zu] %.*s", id, part + 1, chunks.size(), static_cast<int>(chunks[part].size()),
+               chunks[part].data());
+    }
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "dawg-log/formatters/text_formatter.hpp"
+#include <chrono>
+#include <fmt/core.h>
 #include <sstream>
 
 using namespace DawgLog;
@@ -6,7 +8,27 @@ using namespace DawgLog;
 std::string TextFormatter::format(const Record& r) {
     std::ostringstream oss;
     oss << r.app_name << ' ' << r.timestamp << " [" << r.tag << "] "
-        << to_string(r.level) << ": " << r.message
-        << ", SOURCE: " << r.src.file << ':' << r.src.line;
+        << to_string(r.level) << ": " << r.message;
+    if (r.duration) {
+        oss << " took " << fmt::format("{:.3f}", std::chrono::duration<double, std::milli>(*r.duration).count())
+            << " ms";
+    }
+    if (r.trace.valid()) {
+        char hex[48];
+        hex_encode(r.trace.trace_id.data(), r.trace.trace_id.size(), hex);
+        hex_encode(r.trace.span_id.data(), r.trace.span_id.size(), hex + 32);
+        oss << ", TRACE: " << std::string_view(hex, 32) << '/' << std::string_view(hex + 32, 16);
+    }
+    if (r.context && !r.context->text.empty()) {
+        oss << ", CONTEXT: " << r.context->text;
+    }
+    if (r.seq != 0) {
+        oss << ", SEQ: ";
+        if (r.seq_mode == SequenceMode::THREAD) {
+            oss << r.thread_id << '.';
+        }
+        oss << r.seq;
+    }
+    oss << ", SOURCE: " << r.src.file << ':' << r.src.line;
     return oss.str();
 }
\ No newline at end of file
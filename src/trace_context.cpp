@@ -0,0 +1,53 @@
+#include "dawg-log/trace_context.hpp"
+
+using namespace DawgLog;
+
+namespace {
+thread_local TraceContext current_context;
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+template<std::size_t N>
+bool parse_hex(std::string_view hex, std::array<std::uint8_t, N> &out) {
+    if (hex.size() != N * 2) {
+        return false;
+    }
+    for (std::size_t i = 0; i < N; ++i) {
+        const int hi = hex_value(hex[2 * i]);
+        const int lo = hex_value(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) {
+            return false;
+        }
+        out[i] = static_cast<std::uint8_t>((hi << 4) | lo);
+    }
+    return true;
+}
+}
+
+bool TraceContext::from_hex(std::string_view trace_hex, std::string_view span_hex, TraceContext &out) {
+    TraceContext parsed;
+    if (!parse_hex(trace_hex, parsed.trace_id) || !parse_hex(span_hex, parsed.span_id)) {
+        return false;
+    }
+    out = parsed;
+    return true;
+}
+
+void DawgLog::set_trace_context(const TraceContext &ctx) {
+    current_context = ctx;
+}
+
+const TraceContext &DawgLog::current_trace_context() {
+    return current_context;
+}
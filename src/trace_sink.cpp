@@ -0,0 +1,102 @@
+#include "dawg-log/sinks/trace_sink.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <unistd.h>
+
+using namespace DawgLog;
+
+TraceSink::TraceSink(std::string path, std::size_t buffer_bytes)
+    : path_(std::move(path)), buffer_bytes_(buffer_bytes), pid_(static_cast<int>(::getpid())) {
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        std::cerr << "Failed to open trace file: " << path_ << ": " << std::strerror(errno) << std::endl;
+        healthy_ = false;
+        return;
+    }
+    buffer_.reserve(buffer_bytes_ + 1024);
+    buffer_ = "[\n";
+}
+
+TraceSink::~TraceSink() {
+    if (fd_ < 0) {
+        return;
+    }
+    std::lock_guard lock(m_);
+    buffer_ += "\n]\n";
+    flush_locked();
+    ::close(fd_);
+}
+
+void TraceSink::write(const Record& r, std::string_view) {
+    using namespace std::chrono;
+    const auto end_us = duration<double, std::micro>(r.time.time_since_epoch()).count();
+
+    nlohmann::json event;
+    event["name"] = r.message;
+    event["cat"] = r.tag;
+    event["pid"] = pid_;
+    event["tid"] = r.thread_id;
+    if (r.duration) {
+        const auto dur_us = duration<double, std::micro>(*r.duration).count();
+        event["ph"] = "X";
+        event["ts"] = end_us - dur_us;
+        event["dur"] = dur_us;
+    } else {
+        event["ph"] = "i";
+        event["s"] = "t";
+        event["ts"] = end_us;
+    }
+    event["args"] = {
+        {"level", to_string(r.level)},
+        {"file", r.src.file},
+        {"line", r.src.line},
+        {"func", r.src.func}
+    };
+    const std::string text = event.dump();
+
+    std::lock_guard lock(m_);
+    if (fd_ < 0) {
+        return;
+    }
+    if (!first_) {
+        buffer_ += ",\n";
+    }
+    first_ = false;
+    buffer_ += text;
+    if (buffer_.size() >= buffer_bytes_) {
+        flush_locked();
+    }
+}
+
+void TraceSink::flush() {
+    std::lock_guard lock(m_);
+    flush_locked();
+}
+
+bool TraceSink::healthy() const {
+    std::lock_guard lock(m_);
+    return healthy_;
+}
+
+void TraceSink::flush_locked() {
+    std::size_t done = 0;
+    while (done < buffer_.size()) {
+        const ssize_t n = ::write(fd_, buffer_.data() + done, buffer_.size() - done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (healthy_) {
+                std::cerr << "Failed to write trace file: " << path_ << ": " << std::strerror(errno) << std::endl;
+            }
+            healthy_ = false;
+            break;
+        }
+        done += static_cast<std::size_t>(n);
+    }
+    buffer_.clear();
+}
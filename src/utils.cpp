@@ -1,15 +1,33 @@
 #include "dawg-log/utils.hpp"
+#include <algorithm>
 #include <array>
 #include <chrono>
 #include <ctime>
 #include <iostream>
+#include <thread>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 using namespace DawgLog;
 
 std::string DawgLog::make_timestamp() {
+    return make_timestamp(std::chrono::system_clock::now());
+}
+
+std::string DawgLog::make_timestamp(std::chrono::system_clock::time_point time) {
     using namespace std::chrono;
-    auto now = system_clock::now();
-    std::time_t t = system_clock::to_time_t(now);
+    std::time_t t = system_clock::to_time_t(time);
+    // Most records of a thread fall in the same second as its previous one.
+    thread_local std::time_t cached_second = -1;
+    thread_local std::string cached;
+    if (t == cached_second) {
+        return cached;
+    }
     std::tm tm{};
 #if defined(_WIN32)
     localtime_s(&tm, &t);
@@ -18,14 +36,92 @@ std::string DawgLog::make_timestamp() {
 #endif
     std::array<char, 9> buf{};
     std::strftime(buf.data(), sizeof(buf), "%H:%M:%S", &tm);
-    return std::string{buf.data()};
+    cached_second = t;
+    cached = buf.data();
+    return cached;
+}
+
+std::uint64_t DawgLog::current_thread_id() {
+    thread_local const std::uint64_t id = [] {
+#if defined(__linux__)
+        return static_cast<std::uint64_t>(::syscall(SYS_gettid));
+#else
+        return static_cast<std::uint64_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+#endif
+    }();
+    return id;
+}
+
+std::uint64_t DawgLog::fast_random() {
+    thread_local std::uint64_t state = [] {
+        // splitmix64 of thread id and time gives distinct, non-zero seeds per thread.
+        std::uint64_t z = current_thread_id() * 0x9e3779b97f4a7c15ULL ^
+                          static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z ^= z >> 31;
+        return z == 0 ? 0x2545f4914f6cdd1dULL : z;
+    }();
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545f4914f6cdd1dULL;
+}
+
+bool DawgLog::random_chance(double probability) {
+    if (probability >= 1.0) {
+        return true;
+    }
+    if (probability <= 0.0) {
+        return false;
+    }
+    // Compare the top 53 bits against the probability scaled to the same range.
+    return static_cast<double>(fast_random() >> 11) < probability * 9007199254740992.0;
+}
+
+#if defined(__SSE2__)
+namespace {
+// Maps 16 nibble values (0..15) to their lowercase hex digits.
+__m128i nibbles_to_hex(__m128i nibbles) {
+    const __m128i letters = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+    const __m128i digits = _mm_add_epi8(nibbles, _mm_set1_epi8('0'));
+    return _mm_add_epi8(digits, _mm_and_si128(letters, _mm_set1_epi8('a' - '0' - 10)));
+}
+}
+#endif
+
+void DawgLog::hex_encode(const std::uint8_t* data, std::size_t len, char* out) {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    for (; i + 16 <= len; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+        const __m128i lo = _mm_and_si128(v, mask);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), nibbles_to_hex(_mm_unpacklo_epi8(hi, lo)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 16), nibbles_to_hex(_mm_unpackhi_epi8(hi, lo)));
+    }
+    if (i + 8 <= len) {
+        const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+        const __m128i lo = _mm_and_si128(v, mask);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), nibbles_to_hex(_mm_unpacklo_epi8(hi, lo)));
+        i += 8;
+    }
+#endif
+    static constexpr char digits[] = "0123456789abcdef";
+    for (; i < len; ++i) {
+        out[2 * i] = digits[data[i] >> 4];
+        out[2 * i + 1] = digits[data[i] & 0x0f];
+    }
 }
 
 const std::map<std::string, SinkType>& DawgLog::get_sink_type() {
     static const std::map<std::string, SinkType> mapping = {
         {"console", SinkType::CONSOLE},
         {"syslog", SinkType::SYSLOG},
-        {"file", SinkType::FILE}
+        {"file", SinkType::FILE},
+        {"trace", SinkType::TRACE}
     };
     return mapping;
 }
@@ -57,3 +153,72 @@ FormatterType DawgLog::string_to_formatter_type(const std::string& type) {
     }
     return it->second;
 }
+
+bool DawgLog::parse_sink_wrap_type(const std::string& type, SinkWrapType& out) {
+    static const std::map<std::string, SinkWrapType> mapping = {
+        {"async", SinkWrapType::ASYNC},
+        {"buffered", SinkWrapType::BUFFERED},
+        {"level_filter", SinkWrapType::LEVEL_FILTER},
+        {"sampled", SinkWrapType::SAMPLED},
+        {"rate_limited", SinkWrapType::RATE_LIMITED}
+    };
+    const auto it = mapping.find(type);
+    if (it == mapping.end()) {
+        return false;
+    }
+    out = it->second;
+    return true;
+}
+
+std::size_t DawgLog::utf8_boundary(std::string_view text, std::size_t pos) {
+    while (pos > 0 && pos < text.size() && (static_cast<unsigned char>(text[pos]) & 0xc0) == 0x80) {
+        --pos;
+    }
+    return pos;
+}
+
+std::size_t DawgLog::utf8_complete_length(std::string_view text) {
+    // The last sequence starts at most three continuation bytes from the end.
+    std::size_t lead = text.size();
+    while (lead > 0 && text.size() - lead < 3 && (static_cast<unsigned char>(text[lead - 1]) & 0xc0) == 0x80) {
+        --lead;
+    }
+    if (lead == 0) {
+        return text.size();
+    }
+    const auto c = static_cast<unsigned char>(text[lead - 1]);
+    if (c < 0xc0) {
+        return text.size();
+    }
+    const std::size_t need = c >= 0xf0 ? 4 : c >= 0xe0 ? 3 : 2;
+    return text.size() - (lead - 1) < need ? lead - 1 : text.size();
+}
+
+std::vector<std::string_view> DawgLog::split_utf8_chunks(std::string_view text, std::size_t max_bytes) {
+    if (max_bytes == 0 || text.size() <= max_bytes) {
+        return {text};
+    }
+    std::vector<std::string_view> chunks;
+    chunks.reserve(text.size() / max_bytes + 1);
+    for (std::size_t pos = 0; pos < text.size();) {
+        const std::size_t end = std::min(pos + max_bytes, text.size());
+        const std::size_t boundary = utf8_boundary(text, end);
+        const std::size_t cut = boundary > pos ? boundary : end;
+        chunks.push_back(text.substr(pos, cut - pos));
+        pos = cut;
+    }
+    return chunks;
+}
+
+std::string DawgLog::truncate_message(std::string_view text, std::size_t max_bytes, std::size_t total_bytes) {
+    if (total_bytes <= max_bytes) {
+        return std::string(text.substr(0, total_bytes));
+    }
+    // text may stop at max_bytes itself, inside a sequence whose rest was never formatted.
+    const std::size_t kept = utf8_complete_length(text.substr(0, std::min(max_bytes, text.size())));
+    std::string out(text.substr(0, kept));
+    out += " [truncated ";
+    out += std::to_string(total_bytes - kept);
+    out += " bytes]";
+    return out;
+}
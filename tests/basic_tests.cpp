@@ -1,14 +1,1010 @@
 #include "dawg-log/logger.hpp"
 #include "dawg-log/config.hpp"
+#include "dawg-log/filter.hpp"
+#include "dawg-log/formatters/json_formatter.hpp"
+#include "dawg-log/formatters/text_formatter.hpp"
+#include "dawg-log/sinks/async_sink.hpp"
+#include "dawg-log/sinks/buffered_sink.hpp"
+#include "dawg-log/sinks/failover_sink.hpp"
+#include "dawg-log/sinks/level_filter_sink.hpp"
+#include "dawg-log/sinks/rate_limited_sink.hpp"
+#include "dawg-log/sinks/sampled_sink.hpp"
+#include "dawg-log/sinks/trace_sink.hpp"
+#include "dawg-log/sinks/file_sink.hpp"
 #include "dawg-log/tagged_logger.hpp"
+#include <atomic>
 #include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <span>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 using namespace DawgLog;
 
+namespace {
+int format_calls = 0;
+
+struct Counted {
+    int value;
+};
+
+struct MoveOnly {
+    std::unique_ptr<int> value;
+};
+}
+
+template<>
+struct fmt::formatter<MoveOnly> : fmt::formatter<int> {
+    auto format(const MoveOnly &m, fmt::format_context &ctx) const {
+        return fmt::formatter<int>::format(*m.value, ctx);
+    }
+};
+
+template<>
+struct fmt::formatter<Counted> : fmt::formatter<int> {
+    auto format(const Counted &c, fmt::format_context &ctx) const {
+        ++format_calls;
+        return fmt::formatter<int>::format(c.value, ctx);
+    }
+};
+
+static void filter_tests() {
+    const auto f = Filter::compile(R"(level >= warning && tag in {db, net} && !message_prefix("healthcheck"))");
+    const SourceLocation src{"main.cpp", 10, "main"};
+    assert(f.evaluate(LogLevel::info, "db", src) == Filter::Result::REJECT);
+    assert(f.evaluate(LogLevel::error, "ui", src) == Filter::Result::REJECT);
+    assert(f.evaluate(LogLevel::error, "db", src) == Filter::Result::NEEDS_MESSAGE);
+    assert(f.matches(Record{LogLevel::error, "db", src, "app", "connection lost"}));
+    assert(!f.matches(Record{LogLevel::error, "db", src, "app", "healthcheck failed"}));
+
+    const auto g = Filter::compile(R"(line < 20 || file_contains("net"))");
+    assert(g.evaluate(LogLevel::debug, "x", src) == Filter::Result::ACCEPT);
+
+    bool threw = false;
+    try {
+        (void) Filter::compile("level >= loud");
+    } catch (const std::invalid_argument &) {
+        threw = true;
+    }
+    assert(threw);
+
+    for (const auto &bad : std::vector<std::string>{"line == 99999999999999999999", std::string(100000, '!') + "true",
+                                  std::string(100000, '(')}) {
+        threw = false;
+        try {
+            (void) Filter::compile(bad);
+        } catch (const std::invalid_argument &) {
+            threw = true;
+        }
+        assert(threw);
+    }
+}
+
+namespace {
+struct CaptureSink : Sink {
+    std::vector<std::string> lines;
+    std::mutex m;
+    void write(const Record &, std::string_view formatted) override {
+        std::lock_guard lock(m);
+        lines.emplace_back(formatted);
+    }
+};
+
+/** Keeps every record it receives, for checks beyond the formatted text */
+struct RecordingSink : Sink {
+    std::vector<Record> records;
+    void write(const Record &r, std::string_view) override { records.push_back(r); }
+};
+
+/** Not derived from Sink: StaticLogger only needs the SinkLike shape */
+struct VectorSink {
+    explicit VectorSink(std::vector<std::string> *out) : out(out) {}
+    void write(const Record &, std::string_view formatted) { out->emplace_back(formatted); }
+    std::vector<std::string> *out;
+};
+
+struct SlowSink : CaptureSink {
+    std::chrono::microseconds delay{0};
+    void write(const Record &r, std::string_view formatted) override {
+        std::this_thread::sleep_for(delay);
+        CaptureSink::write(r, formatted);
+    }
+};
+}
+
+static void failover_tests() {
+    auto capture = std::make_unique<CaptureSink>();
+    auto *captured = capture.get();
+    std::vector<SinkPtr> fallbacks;
+    fallbacks.push_back(std::move(capture));
+    FailoverSink sink{std::make_unique<FileSink>("/nonexistent-dir/dawglog.log"), std::move(fallbacks), {}};
+    const Record rec{LogLevel::info, "t", LOG_SRC, "app", "hello"};
+    sink.write(rec, "hello");
+    assert(sink.active_index() == 1);
+    assert(captured->lines.size() == 1 && captured->lines[0] == "hello");
+
+    // A stalled primary must not hold up other writers.
+    auto slow = std::make_unique<SlowSink>();
+    slow->delay = std::chrono::milliseconds{400};
+    auto fallback = std::make_unique<CaptureSink>();
+    auto *fallback_lines = fallback.get();
+    std::vector<SinkPtr> stall_fallbacks;
+    stall_fallbacks.push_back(std::move(fallback));
+    FailoverOptions options;
+    options.latency_threshold = std::chrono::milliseconds{50};
+    FailoverSink stall_group{std::move(slow), std::move(stall_fallbacks), options};
+    std::thread stuck([&] { stall_group.write(rec, "stuck"); });
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    const auto start = std::chrono::steady_clock::now();
+    stall_group.write(rec, "rerouted");
+    assert(std::chrono::steady_clock::now() - start < std::chrono::milliseconds{200});
+    assert(fallback_lines->lines.size() == 1 && fallback_lines->lines[0] == "rerouted");
+    stuck.join();
+}
+
+static void durable_file_tests() {
+    const auto path = std::filesystem::temp_directory_path() / "dawglog_durable_test.log";
+    std::filesystem::remove(path);
+    FileSinkOptions options;
+    options.durable = true;
+    options.commit_max_wait = std::chrono::microseconds{2000};
+    FileSink sink{path.string(), options};
+    const Record rec{LogLevel::info, "t", LOG_SRC, "app", "durable"};
+    std::vector<std::thread> writers;
+    for (int i = 0; i < 4; ++i) {
+        writers.emplace_back([&] {
+            for (int j = 0; j < 25; ++j) {
+                sink.write(rec, "durable");
+            }
+        });
+    }
+    for (auto &w : writers) {
+        w.join();
+    }
+    const auto stats = sink.stats();
+    assert(stats.committed_records == 100);
+    assert(stats.commits >= 1 && stats.commits <= 100);
+    std::filesystem::remove(path);
+}
+
+static void file_writeback_tests() {
+    const auto path = std::filesystem::temp_directory_path() / "dawglog_writeback_test.log";
+    std::filesystem::remove(path);
+    FileSinkOptions options;
+    options.preallocate_bytes = 1 << 20;
+    options.writeback_bytes = 4096;
+    options.drop_cache = true;
+    const std::string line(99, 'w');
+    FileSinkStats stats;
+    {
+        FileSink sink{path.string(), options};
+        const Record rec{LogLevel::info, "t", LOG_SRC, "app", line};
+        for (int i = 0; i < 200; ++i) {
+            sink.write(rec, line);
+        }
+        assert(sink.healthy());
+        stats = sink.stats();
+    }
+    assert(stats.writeback_windows >= 2);
+    struct stat st{};
+    assert(::stat(path.c_str(), &st) == 0);
+    // KEEP_SIZE preallocation never shows in st_size, and close trims the reserved tail.
+    assert(st.st_size == 200 * 100);
+    if (stats.preallocations > 0) {
+        assert(static_cast<std::uint64_t>(st.st_blocks) * 512 < options.preallocate_bytes);
+    }
+    std::filesystem::remove(path);
+}
+
+static std::string read_file(const std::filesystem::path &path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+static void direct_io_tests() {
+    FileSinkOptions options;
+    options.direct_io = true;
+    options.direct_block_bytes = 4096;
+    const std::string line(299, 'd');
+    const Record rec{LogLevel::info, "t", LOG_SRC, "app", line};
+    std::string expected;
+    for (int i = 0; i < 30; ++i) {
+        expected += line + '\n';
+    }
+
+    // ext4/xfs take the O_DIRECT path; tmpfs before Linux 6.6 rejects O_DIRECT and exercises the fallback.
+    std::vector<std::filesystem::path> dirs{std::filesystem::temp_directory_path()};
+    if (std::filesystem::is_directory("/dev/shm")) {
+        dirs.emplace_back("/dev/shm");
+    }
+    for (const auto &dir : dirs) {
+        const auto path = dir / "dawglog_direct_test.log";
+        std::filesystem::remove(path);
+        {
+            FileSink sink{path.string(), options};
+            for (int i = 0; i < 20; ++i) {
+                sink.write(rec, line);
+            }
+            // Two full blocks are on disk, the partial tail is written padded and trimmed.
+            sink.flush();
+            assert(std::filesystem::file_size(path) == 20 * 300);
+            for (int i = 0; i < 5; ++i) {
+                sink.write(rec, line);
+            }
+            // Reopening must not lose the staged tail.
+            assert(sink.reopen());
+            for (int i = 0; i < 5; ++i) {
+                sink.write(rec, line);
+            }
+            assert(sink.healthy());
+        }
+        assert(read_file(path) == expected);
+        std::filesystem::remove(path);
+    }
+}
+
+static void trace_sink_tests() {
+    const auto path = std::filesystem::temp_directory_path() / "dawglog_trace_test.json";
+    {
+        TraceSink sink{path.string(), 1};
+        const Record rec{LogLevel::info, "net", LOG_SRC, "app", "said \"hi\""};
+        Record span{LogLevel::debug, "db", LOG_SRC, "app", "query"};
+        span.duration = std::chrono::milliseconds{5};
+        sink.write(rec, "ignored");
+        sink.write(span, "ignored");
+        // Mid-run the file is an unterminated array, which trace viewers accept.
+        const auto partial = nlohmann::json::parse(read_file(path) + "]");
+        assert(partial.size() == 2);
+        assert(partial[0]["ph"] == "i" && partial[0]["name"] == "said \"hi\"" && partial[0]["cat"] == "net");
+        assert(partial[1]["ph"] == "X" && partial[1]["dur"] == 5000.0);
+        sink.write(rec, "ignored");
+    }
+    const auto closed = nlohmann::json::parse(read_file(path));
+    assert(closed.is_array() && closed.size() == 3);
+    assert(closed[2]["args"]["level"] == "INFO");
+    std::filesystem::remove(path);
+}
+
+static void span_tests() {
+    auto capture = std::make_unique<CaptureSink>();
+    auto *captured = capture.get();
+    Logger::init(Config{"config.json"}, std::move(capture));
+    TaggedLogger t("span");
+    {
+        DAWGLOG_SCOPE(t, "work");
+    }
+    {
+        DAWGLOG_SCOPE_OVER(t, "fast", std::chrono::seconds{10});
+    }
+    assert(captured->lines.size() == 1);
+    assert(captured->lines[0].find("work took") != std::string::npos);
+}
+
+static void context_tests() {
+    JsonFormatter json;
+    TextFormatter text;
+    {
+        Context outer{{"request_id", 42}};
+        Context inner{{"user", "bob \"b\""}};
+        const Record rec{LogLevel::info, "t", LOG_SRC, "app", "hi"};
+        const auto parsed = nlohmann::json::parse(json.format(rec));
+        assert(parsed["context"]["request_id"] == "42");
+        assert(parsed["context"]["user"] == "bob \"b\"");
+        assert(text.format(rec).find("CONTEXT: request_id=42 user=bob") != std::string::npos);
+    }
+    {
+        Context empty{};
+        const Record rec{LogLevel::info, "t", LOG_SRC, "app", "hi"};
+        assert(text.format(rec).find("CONTEXT") == std::string::npos);
+        assert(!nlohmann::json::parse(json.format(rec)).contains("context"));
+    }
+    const Record rec{LogLevel::info, "t", LOG_SRC, "app", "hi"};
+    assert(!rec.context);
+}
+
+static void trace_context_tests() {
+    const std::uint8_t bytes[] = {0x00, 0x1f, 0xa0, 0xff, 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0,
+                                  0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0x7e};
+    char hex[2 * sizeof(bytes)];
+    hex_encode(bytes, sizeof(bytes), hex);
+    assert(std::string_view(hex, sizeof(hex)) == "001fa0ff123456789abcdef00123456789abcdef7e");
+
+    TraceContext ctx;
+    assert(TraceContext::from_hex("4bf92f3577b34da6a3ce929d0e0e4736", "00f067aa0ba902b7", ctx));
+    assert(!TraceContext::from_hex("4bf92f", "00f067aa0ba902b7", ctx));
+    TextFormatter text;
+    JsonFormatter json;
+    {
+        TraceScope scope{ctx};
+        const Record rec{LogLevel::info, "t", LOG_SRC, "app", "hi"};
+        assert(text.format(rec).find("TRACE: 4bf92f3577b34da6a3ce929d0e0e4736/00f067aa0ba902b7") !=
+               std::string::npos);
+        assert(nlohmann::json::parse(json.format(rec))["span_id"] == "00f067aa0ba902b7");
+    }
+    assert(!current_trace_context().valid());
+}
+
+static void backtrace_tests() {
+    auto capture = std::make_unique<CaptureSink>();
+    auto *captured = capture.get();
+    Logger::init(Config{"config.json"}, std::move(capture));
+    auto &logger = Logger::instance();
+    logger.set_level(LogLevel::info);
+    logger.enable_backtrace(4);
+    TaggedLogger t("bt");
+    for (int i = 0; i < 6; ++i) {
+        t.debug(LOG_SRC, "step {} {}", std::string("s") + std::to_string(i), Counted{i});
+    }
+    assert(captured->lines.empty());
+    assert(format_calls == 0);
+    t.error(LOG_SRC, "failed");
+    assert(captured->lines.size() == 5);
+    assert(captured->lines[0].find("step s2 2") != std::string::npos);
+    assert(captured->lines[3].find("step s5 5") != std::string::npos);
+    assert(captured->lines[4].find("failed") != std::string::npos);
+    assert(format_calls == 4);
+    t.error(LOG_SRC, "again");
+    assert(captured->lines.size() == 6);
+}
+
+static void request_scope_tests() {
+    auto capture = std::make_unique<CaptureSink>();
+    auto *captured = capture.get();
+    Logger::init(Config{"config.json"}, std::move(capture));
+    TaggedLogger t("req");
+    {
+        RequestScope scope{"r1"};
+        t.info(LOG_SRC, "quiet request");
+    }
+    assert(captured->lines.empty());
+    {
+        RequestScope scope{"r2"};
+        t.info(LOG_SRC, "loud request");
+        t.error(LOG_SRC, "request failed");
+        assert(captured->lines.empty());
+    }
+    assert(captured->lines.size() == 2);
+    assert(captured->lines[0].find("loud request") != std::string::npos);
+    assert(captured->lines[0].find("request_id=r2") != std::string::npos);
+    {
+        RequestScope scope{"r3", RequestSamplingOptions{.sample_rate = 1.0}};
+        t.info(LOG_SRC, "sampled request");
+    }
+    assert(captured->lines.size() == 3);
+
+    // Views and move-only arguments are formatted before the scope's locals are gone.
+    static_assert(!detail::capturable_arg<decltype(fmt::join(std::vector<int>{}, ","))>());
+    static_assert(!detail::capturable_arg<std::span<const int>>());
+    static_assert(detail::capturable_arg<std::vector<int>>() && detail::capturable_arg<const char *>());
+    {
+        RequestScope scope{"r4"};
+        {
+            std::vector<int> ids{1, 2, 3};
+            t.info(LOG_SRC, "ids {} owner {}", fmt::join(ids, ","), MoveOnly{std::make_unique<int>(4)});
+            ids.assign(64, 9);
+        }
+        t.error(LOG_SRC, "request failed");
+    }
+    assert(captured->lines[captured->lines.size() - 2].find("ids 1,2,3 owner 4") != std::string::npos);
+}
+
+static void sampling_tests() {
+    auto capture = std::make_unique<CaptureSink>();
+    auto *captured = capture.get();
+    Logger::init(Config{"config.json"}, std::move(capture));
+    TaggedLogger t("hot");
+    int evaluated = 0;
+    for (int i = 0; i < 10; ++i) {
+        TAG_INFO_EVERY_N(t, 4, "every {}", ++evaluated);
+    }
+    assert(captured->lines.size() == 3);
+    assert(evaluated == 3);
+    for (int i = 0; i < 10; ++i) {
+        TAG_INFO_FIRST_N(t, 2, "first {}", i);
+        TAG_INFO_EVERY_MS(t, 60000, "periodic {}", i);
+        TAG_INFO_SAMPLED(t, 0.0, "never {}", ++evaluated);
+    }
+    assert(captured->lines.size() == 6);
+    assert(evaluated == 3);
+}
+
+static void lazy_tests() {
+    auto capture = std::make_unique<CaptureSink>();
+    auto *captured = capture.get();
+    Logger::init(Config{"config.json"}, std::move(capture));
+    auto &logger = Logger::instance();
+    logger.set_level(LogLevel::info);
+    TaggedLogger t("lazy");
+    int calls = 0;
+    auto dump = [&] { ++calls; return std::string("big state"); };
+    t.debug(LOG_SRC, "state {}", lazy(dump));
+    assert(calls == 0);
+    t.info(LOG_SRC, "state {:>10}", lazy(dump));
+    assert(calls == 1);
+    assert(captured->lines.back().find("state  big state") != std::string::npos);
+    logger.enable_backtrace(2);
+    t.debug(LOG_SRC, "deferred {}", lazy(dump));
+    assert(calls == 2);
+    t.error(LOG_SRC, "boom");
+    assert(calls == 2);
+    assert(captured->lines[captured->lines.size() - 2].find("deferred big state") != std::string::npos);
+
+    const auto owned_calls = std::make_shared<int>(0);
+    const auto owned = [owned_calls] { ++*owned_calls; return std::string("owned state"); };
+    t.debug(LOG_SRC, "kept {}", lazy_owned(owned));
+    t.debug(LOG_SRC, "kept {}", lazy_owned(owned));
+    assert(*owned_calls == 0);
+    t.error(LOG_SRC, "boom");
+    assert(*owned_calls == 2);
+    assert(captured->lines[captured->lines.size() - 2].find("kept owned state") != std::string::npos);
+
+    // Move-only arguments cannot be stored unformatted; they are formatted at capture.
+    static_assert(!detail::capturable_arg<MoveOnly>());
+    t.debug(LOG_SRC, "moved {} {}", MoveOnly{std::make_unique<int>(7)}, std::string("along"));
+    t.info(LOG_SRC, "written {}", MoveOnly{std::make_unique<int>(8)});
+    assert(captured->lines.back().find("written 8") != std::string::npos);
+    t.error(LOG_SRC, "boom");
+    assert(captured->lines[captured->lines.size() - 2].find("moved 7 along") != std::string::npos);
+    logger.enable_backtrace(0);
+}
+
+static void metrics_tests() {
+    const auto path = std::filesystem::temp_directory_path() / "dawglog_metrics.prom";
+    std::filesystem::remove(path);
+    Logger::init(Config{"config.json"}, std::make_unique<CaptureSink>());
+    auto &logger = Logger::instance();
+    logger.set_level(LogLevel::warning);
+    logger.set_metrics_file(path.string(), std::chrono::hours{1});
+    TaggedLogger db("db");
+    for (int i = 0; i < 3; ++i) {
+        db.debug(LOG_SRC, "filtered {}", i);
+    }
+    db.error(LOG_SRC, "failed");
+    const auto &metrics = logger.metrics();
+    assert(metrics.level_count(LogLevel::debug) == 3);
+    assert(metrics.level_count(LogLevel::error) == 1);
+    assert(metrics.tag_count("db") == 4);
+    assert(metrics.site_counts().front().count == 3);
+    assert(metrics.error_rate(std::chrono::seconds{10}) > 0.0);
+    logger.set_metrics_file("", std::chrono::hours{1});
+    std::ifstream in(path);
+    const std::string text{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    assert(text.find("dawglog_records_total{level=\"debug\"} 3") != std::string::npos);
+    assert(text.find("dawglog_tag_records_total{tag=\"db\"} 4") != std::string::npos);
+    std::filesystem::remove(path);
+
+    // One call site alternating between tags must not credit the site's cached tag.
+    Logger::init(Config{"config.json"}, std::make_unique<CaptureSink>());
+    auto &relogged = Logger::instance();
+    relogged.set_level(LogLevel::critical);
+    relogged.enable_metrics(true);
+    TaggedLogger a("alpha");
+    TaggedLogger b("beta");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i) {
+                (i % 4 == 0 ? b : a).error(LOG_SRC, "burst");
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    const auto &fresh = relogged.metrics();
+    assert(fresh.tag_count("alpha") == 3000);
+    assert(fresh.tag_count("beta") == 1000);
+    assert(fresh.site_counts().front().count == 4000);
+    assert(fresh.error_rate(std::chrono::seconds{60}) * 60.0 > 3999.0);
+}
+
+static void profiler_tests() {
+    Logger::init(Config{"config.json"}, std::make_unique<CaptureSink>());
+    auto &logger = Logger::instance();
+    TaggedLogger t("prof");
+    t.info(LOG_SRC, "not profiled");
+    assert(logger.profile().empty());
+    logger.enable_profiling(true);
+    for (int i = 0; i < 5; ++i) {
+        t.info(LOG_SRC, "big {}", std::string(1000, 'x'));
+    }
+    t.info(LOG_SRC, "small");
+    logger.enable_profiling(false);
+    const auto profile = logger.profile();
+    assert(profile.size() == 2);
+    assert(profile.front().calls == 5);
+    assert(profile.front().bytes > 5000);
+    assert(logger.profile_report().find("basic_tests.cpp") != std::string::npos);
+}
+
+static void control_tests() {
+    auto capture = std::make_unique<CaptureSink>();
+    auto *captured = capture.get();
+    Logger::init(Config{"config.json"}, std::move(capture));
+    auto &logger = Logger::instance();
+    TaggedLogger db("db");
+    TaggedLogger net("net");
+    assert(logger.control("level warning") == "ok\n");
+    assert(logger.control("level tag db debug") == "ok\n");
+    db.debug(LOG_SRC, "db verbose");
+    net.info(LOG_SRC, "net quiet");
+    assert(captured->lines.size() == 1);
+    assert(logger.control("level site basic_tests.cpp:0 critical") == "ok\n");
+    db.error(LOG_SRC, "site silenced");
+    assert(captured->lines.size() == 1);
+    assert(logger.control("level site basic_tests.cpp:0 reset") == "ok\n");
+    assert(logger.control("level target 0 error") == "ok\n");
+    db.warning(LOG_SRC, "below target");
+    assert(captured->lines.size() == 1);
+    assert(logger.control("level target 7 error").rfind("error:", 0) == 0);
+    assert(logger.control("bogus").rfind("error:", 0) == 0);
+
+    const auto path = (std::filesystem::temp_directory_path() / "dawglog_control.sock").string();
+    assert(logger.set_control_socket(path));
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    assert(::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+    const std::string request = "level info\nlevel\n";
+    assert(::write(fd, request.data(), request.size()) == static_cast<ssize_t>(request.size()));
+    std::string reply;
+    char buf[64];
+    while (reply.size() < 8) {
+        const ssize_t n = ::read(fd, buf, sizeof(buf));
+        assert(n > 0);
+        reply.append(buf, static_cast<std::size_t>(n));
+    }
+    assert(reply == "ok\nINFO\n");
+    ::close(fd);
+    logger.set_control_socket("");
+    assert(!std::filesystem::exists(path));
+
+    // Re-initialising with the same socket keeps it bound and owner-only.
+    Config with_socket{"config.json"};
+    with_socket.control_socket = path;
+    Logger::init(with_socket, std::make_unique<CaptureSink>());
+    Logger::init(with_socket, std::make_unique<CaptureSink>());
+    struct stat st{};
+    assert(::lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode));
+    assert((st.st_mode & 0777) == 0600);
+    Logger::instance().set_control_socket("");
+    assert(!std::filesystem::exists(path));
+    // A regular file at the path is not clobbered.
+    std::ofstream(path) << "keep";
+    assert(!Logger::instance().set_control_socket(path));
+    assert(read_file(path) == "keep");
+    std::filesystem::remove(path);
+
+    const auto log_path = std::filesystem::temp_directory_path() / "dawglog_rotate.log";
+    const auto rotated = std::filesystem::temp_directory_path() / "dawglog_rotate.log.1";
+    std::filesystem::remove(log_path);
+    Logger::init(Config{"config.json"}, std::make_unique<FileSink>(log_path.string()));
+    TAG_INFO(db, "before rotation");
+    std::filesystem::rename(log_path, rotated);
+    assert(Logger::instance().control("rotate") == "ok\n");
+    TAG_INFO(db, "after rotation");
+    std::ifstream fresh(log_path);
+    const std::string text{std::istreambuf_iterator<char>(fresh), std::istreambuf_iterator<char>()};
+    assert(text.find("after rotation") != std::string::npos);
+    assert(text.find("before rotation") == std::string::npos);
+    std::filesystem::remove(log_path);
+    std::filesystem::remove(rotated);
+}
+
+static void overload_tests() {
+    auto slow = std::make_unique<SlowSink>();
+    auto *sink = slow.get();
+    Logger::init(Config{"config.json"}, std::move(slow));
+    auto &logger = Logger::instance();
+    OverloadOptions options;
+    options.enabled = true;
+    options.latency_high = std::chrono::microseconds{500};
+    options.latency_low = std::chrono::microseconds{100};
+    options.cooldown = std::chrono::milliseconds{50};
+    logger.set_overload_protection(options);
+    logger.enable_backtrace(16);
+    TaggedLogger t("storm");
+    sink->delay = std::chrono::milliseconds{2};
+    for (int i = 0; i < 10 && logger.overload_floor() == LogLevel::debug; ++i) {
+        t.debug(LOG_SRC, "flood {}", i);
+    }
+    assert(logger.overload_floor() > LogLevel::debug);
+    assert(sink->lines.back().find("Logging overloaded") != std::string::npos);
+    const auto written = sink->lines.size();
+    t.debug(LOG_SRC, "dropped while overloaded");
+    assert(sink->lines.size() == written);
+    // Nothing above the floor is logged; a quiet cooldown alone lowers it again.
+    sink->delay = std::chrono::microseconds{0};
+    for (int i = 0; i < 200 && logger.overload_floor() != LogLevel::debug; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        t.debug(LOG_SRC, "quiet {}", i);
+    }
+    assert(logger.overload_floor() == LogLevel::debug);
+    assert(sink->lines.back().find("Logging load recovered") != std::string::npos);
+    // Records shed for overload never reach the backtrace buffer.
+    t.error(LOG_SRC, "failure");
+    for (const auto &line : sink->lines) {
+        assert(line.find("dropped while overloaded") == std::string::npos);
+        assert(line.find("quiet") == std::string::npos);
+    }
+}
+
+static void clock_tests() {
+    using namespace std::chrono;
+    for (const auto source : {ClockSource::REALTIME_COARSE, ClockSource::MONOTONIC, ClockSource::TSC}) {
+        set_clock_source(source);
+        const auto diff = clock_now() - system_clock::now();
+        assert(diff < seconds{1} && diff > -seconds{1});
+        const auto a = monotonic_now();
+        const auto b = monotonic_now();
+        assert(b >= a);
+    }
+    // The TSC conversion is re-anchored every second; monotonic time must not step back.
+    set_clock_source(ClockSource::TSC);
+    auto last = monotonic_now();
+    for (const auto end = steady_clock::now() + milliseconds{1200}; steady_clock::now() < end;) {
+        const auto now = monotonic_now();
+        assert(now >= last);
+        last = now;
+    }
+    set_monotonic_timestamps(true);
+    const Record rec{LogLevel::info, "t", LOG_SRC, "app", "hi"};
+    assert(rec.monotonic.has_value());
+    assert(nlohmann::json::parse(JsonFormatter{}.format(rec)).contains("mono_ns"));
+    set_monotonic_timestamps(false);
+    set_clock_source(ClockSource::REALTIME);
+    assert(make_timestamp(system_clock::time_point{}) == make_timestamp(system_clock::time_point{}));
+}
+
+static void sequence_tests() {
+    set_sequence_mode(SequenceMode::GLOBAL);
+    const Record first{LogLevel::info, "t", LOG_SRC, "app", "a"};
+    std::uint64_t other = 0;
+    std::thread([&] { other = Record{LogLevel::info, "t", LOG_SRC, "app", "b"}.seq; }).join();
+    assert(first.seq != 0 && other == first.seq + 1);
+    assert(TextFormatter{}.format(first).find(", SEQ: " + std::to_string(first.seq)) != std::string::npos);
+
+    set_sequence_mode(SequenceMode::THREAD);
+    const Record a{LogLevel::info, "t", LOG_SRC, "app", "a"};
+    const Record b{LogLevel::info, "t", LOG_SRC, "app", "b"};
+    assert(b.seq == a.seq + 1);
+    assert(nlohmann::json::parse(JsonFormatter{}.format(b))["seq"] == b.seq);
+
+    // Materializing a captured record must not consume a number of its own.
+    const auto deferred = DeferredRecord::capture(LogLevel::info, "t", LOG_SRC, "{}", "d");
+    const Record before{LogLevel::info, "t", LOG_SRC, "app", "e"};
+    const Record materialized = deferred.materialize("app");
+    const Record after{LogLevel::info, "t", LOG_SRC, "app", "f"};
+    assert(materialized.seq == deferred.seq && after.seq == before.seq + 1);
+
+    set_sequence_mode(SequenceMode::OFF);
+    assert((Record{LogLevel::info, "t", LOG_SRC, "app", "c"}.seq == 0));
+    // The prefix follows the mode the record was numbered under, not the current one.
+    assert(TextFormatter{}.format(b).find(", SEQ: " + std::to_string(b.thread_id) + '.') != std::string::npos);
+    set_sequence_mode(SequenceMode::THREAD);
+    assert(TextFormatter{}.format(first).find(", SEQ: " + std::to_string(first.seq) + ", SOURCE") !=
+           std::string::npos);
+    set_sequence_mode(SequenceMode::OFF);
+}
+
+static void static_logger_tests() {
+    static_assert(SinkLike<FileSink> && SinkLike<VectorSink> && !SinkLike<TextFormatter>);
+    static_assert(FormatterLike<JsonFormatter> && !FormatterLike<VectorSink>);
+    std::vector<std::string> text_lines;
+    std::vector<std::string> json_lines;
+    StaticLogger<Target<VectorSink, TextFormatter>, Target<VectorSink, JsonFormatter>> logger{
+        "static-app", &text_lines, &json_lines};
+    logger.set_level(LogLevel::info);
+    auto net = logger.tagged("net");
+    TAG_DEBUG(net, "hidden");
+    TAG_INFO(net, "listening on {}", 8080);
+    assert(text_lines.size() == 1 && json_lines.size() == 1);
+    assert(text_lines[0].find("static-app") != std::string::npos);
+    assert(text_lines[0].find("[net] INFO: listening on 8080") != std::string::npos);
+    assert(nlohmann::json::parse(json_lines[0])["message"] == "listening on 8080");
+}
+
+static void decorator_tests() {
+    auto capture = std::make_unique<CaptureSink>();
+    auto *captured = capture.get();
+    AsyncSink sink{std::make_unique<BufferedSink>(std::move(capture), 1024)};
+    const Record info{LogLevel::info, "t", LOG_SRC, "app", "a"};
+    const Record warn{LogLevel::warning, "t", LOG_SRC, "app", "w"};
+    sink.write(info, "a");
+    sink.write(info, "b");
+    sink.write(warn, "w");
+    sink.write(info, "c");
+    sink.flush();
+    // How the batches split depends on the worker's timing; order and content do not.
+    std::string joined;
+    for (const auto &line : captured->lines) {
+        joined += (joined.empty() ? "" : "\n") + line;
+    }
+    assert(joined == "a\nb\nw\nc");
+
+    // Sinks without a batched write still see each record with its own level and message.
+    auto recording = std::make_unique<RecordingSink>();
+    auto *recorded = recording.get();
+    BufferedSink buffered{std::move(recording), 1024};
+    const Record debug{LogLevel::debug, "t", LOG_SRC, "app", "b"};
+    buffered.write(info, "a");
+    buffered.write(debug, "b");
+    assert(recorded->records.empty());
+    buffered.write(warn, "w");
+    assert(recorded->records.size() == 3);
+    assert(recorded->records[0].level == LogLevel::info && recorded->records[0].message == "a");
+    assert(recorded->records[1].level == LogLevel::debug && recorded->records[1].message == "b");
+    assert(recorded->records[2].level == LogLevel::warning && recorded->records[2].message == "w");
+
+    const auto batch_path = std::filesystem::temp_directory_path() / "dawglog_batch.log";
+    std::filesystem::remove(batch_path);
+    {
+        BufferedSink batched{std::make_unique<FileSink>(batch_path.string()), 1024};
+        batched.write(info, "a");
+        batched.write(debug, "b");
+        batched.flush();
+        batched.write(info, "c");
+    }
+    assert(read_file(batch_path) == "a\nb\nc\n");
+    std::filesystem::remove(batch_path);
+
+    auto filtered_capture = std::make_unique<CaptureSink>();
+    auto *filtered = filtered_capture.get();
+    LevelFilterSink level_filter{std::make_unique<SampledSink>(std::move(filtered_capture), 0.0), LogLevel::warning};
+    const Record err{LogLevel::error, "t", LOG_SRC, "app", "e"};
+    level_filter.write(info, "a");
+    level_filter.write(warn, "w");
+    level_filter.write(err, "e");
+    assert(filtered->lines.size() == 1 && filtered->lines[0] == "e");
+
+    auto limited_capture = std::make_unique<CaptureSink>();
+    auto *limited_lines = limited_capture.get();
+    RateLimitedSink limited{std::move(limited_capture), 0.001, 2};
+    for (int i = 0; i < 5; ++i) {
+        limited.write(info, "x");
+    }
+    assert(limited_lines->lines.size() == 2 && limited.dropped() == 3);
+
+    // The suppression notice goes through the target's formatter, so JSON stays JSON.
+    auto json_capture = std::make_unique<CaptureSink>();
+    auto *json_lines = json_capture.get();
+    RateLimitedSink json_limited{std::move(json_capture), 20.0, 1, std::make_unique<JsonFormatter>()};
+    json_limited.write(info, "{}");
+    json_limited.write(info, "{}");
+    std::this_thread::sleep_for(std::chrono::milliseconds{60});
+    json_limited.write(info, "{}");
+    assert(json_lines->lines.size() == 3);
+    const auto notice = nlohmann::json::parse(json_lines->lines[1]);
+    assert(notice["level"] == "WARN" && notice["message"] == "Rate limit suppressed 1 records");
+
+    const auto config_path = std::filesystem::temp_directory_path() / "dawglog_wrap.json";
+    std::ofstream(config_path) << R"({ "sink": "console",
+        "wrap": [ "async", { "type": "rate_limited", "per_second": 5, "burst": 2 }, "bogus", 7 ],
+        "targets": [ { "sink": "console", "format": "json",
+                       "wrap": [ { "type": "level_filter", "level": "error" },
+                                 { "type": "buffered", "bytes": 128 } ] } ] })";
+    const Config cfg{config_path.string()};
+    std::filesystem::remove(config_path);
+    assert(cfg.wrap.size() == 2);
+    assert(cfg.wrap[0].type == SinkWrapType::ASYNC);
+    assert(cfg.wrap[1].type == SinkWrapType::RATE_LIMITED);
+    assert(cfg.wrap[1].per_second == 5.0 && cfg.wrap[1].burst == 2);
+    assert(cfg.targets.size() == 1 && cfg.targets[0].wrap.size() == 2);
+    assert(cfg.targets[0].wrap[0].type == SinkWrapType::LEVEL_FILTER);
+    assert(cfg.targets[0].wrap[0].level == LogLevel::error);
+    assert(cfg.targets[0].wrap[1].type == SinkWrapType::BUFFERED && cfg.targets[0].wrap[1].bytes == 128);
+}
+
+static void emergency_tests() {
+    int pipe_fds[2];
+    assert(pipe(pipe_fds) == 0);
+    set_emergency_fds(&pipe_fds[1], 1);
+    emergency(LOG_SRC, "caught signal", 11);
+    emergency_hex(LOG_SRC, "fault address", 0xdead);
+    emergency(LOG_SRC, "negative", -5);
+    char buf[1024];
+    const ssize_t n = read(pipe_fds[0], buf, sizeof(buf));
+    assert(n > 0);
+    const std::string out(buf, static_cast<std::size_t>(n));
+    assert(out.find("[EMERGENCY] CRITICAL: caught signal 11, SOURCE: ") != std::string::npos);
+    assert(out.find("fault address 0xdead") != std::string::npos);
+    assert(out.find("negative -5") != std::string::npos);
+    Logger::instance().reopen();
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+
+    // The registered descriptors follow sinks that reopen or fail over behind the logger's back.
+    const auto dir = std::filesystem::temp_directory_path();
+    const auto primary = dir / "dawglog_emergency.log";
+    const auto moved = dir / "dawglog_emergency.log.1";
+    const auto fallback = dir / "dawglog_emergency_fallback.log";
+    for (const auto &path : {primary, moved, fallback}) {
+        std::filesystem::remove(path);
+    }
+    auto file = std::make_unique<FileSink>(primary.string());
+    auto *raw = file.get();
+    Logger::init(Config{"config.json"}, std::move(file));
+    TaggedLogger t("emergency");
+    t.info(LOG_SRC, "first");
+    std::filesystem::rename(primary, moved);
+    raw->reopen();
+    t.info(LOG_SRC, "second");
+    emergency(LOG_SRC, "after reopen");
+    assert(read_file(primary).find("after reopen") != std::string::npos);
+    assert(read_file(moved).find("after reopen") == std::string::npos);
+
+    std::vector<SinkPtr> fallbacks;
+    fallbacks.push_back(std::make_unique<FileSink>(fallback.string()));
+    Logger::init(Config{"config.json"},
+                 std::make_unique<FailoverSink>(std::make_unique<FileSink>("/nonexistent-dir/dawglog.log"),
+                                                std::move(fallbacks), FailoverOptions{}));
+    t.info(LOG_SRC, "fails over");
+    emergency(LOG_SRC, "after failover");
+    assert(read_file(fallback).find("after failover") != std::string::npos);
+    Logger::init(Config{"config.json"}, std::make_unique<CaptureSink>());
+    for (const auto &path : {primary, moved, fallback}) {
+        std::filesystem::remove(path);
+    }
+}
+
+static void stdio_capture_tests() {
+    std::mutex m;
+    std::vector<std::pair<int, std::string>> lines;
+    {
+        StdioCapture capture{[&](int stream, std::string_view line) {
+            std::lock_guard lock(m);
+            lines.emplace_back(stream, line);
+        }};
+        assert(original_stdout() != STDOUT_FILENO);
+        std::printf("from printf\n");
+        std::fflush(stdout);
+        assert(write(STDERR_FILENO, "raw one\r\nraw two\n\npartial", 25) == 25);
+        bool threw = false;
+        try {
+            StdioCapture second{[](int, std::string_view) {}};
+        } catch (const std::logic_error &) {
+            threw = true;
+        }
+        assert(threw);
+    }
+    assert(original_stdout() == STDOUT_FILENO && original_stderr() == STDERR_FILENO);
+    const std::vector<std::pair<int, std::string>> expected{
+        {1, "from printf"}, {2, "raw one"}, {2, "raw two"}, {2, "partial"}};
+    assert(lines == expected);
+
+    // An ending capture leaves the saved descriptors open while a writer holds a guard.
+    auto ending = std::make_unique<StdioCapture>([](int, std::string_view) {});
+    auto guard = std::make_optional<OriginalStdioGuard>();
+    const int saved = guard->out();
+    assert(saved != STDOUT_FILENO);
+    std::atomic<bool> ended{false};
+    std::thread teardown([&] {
+        ending.reset();
+        ended = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    assert(!ended && fcntl(saved, F_GETFD) != -1);
+    guard.reset();
+    teardown.join();
+    assert(ended && original_stdout() == STDOUT_FILENO);
+
+    auto sink = std::make_unique<CaptureSink>();
+    auto *captured = sink.get();
+    Logger::init(Config{"config.json"}, std::move(sink));
+    StdioCaptureOptions options;
+    options.enabled = true;
+    options.tag = "lib";
+    assert(Logger::instance().set_stdio_capture(options));
+    std::printf("hello from lib\n");
+    Logger::instance().set_stdio_capture({});
+    assert(captured->lines.size() == 1);
+    assert(captured->lines[0].find("[lib] INFO: hello from lib") != std::string::npos);
+}
+
+static void large_message_tests() {
+    const std::string big(100000, 'x');
+    const std::string limited = Logger::format_message(16, "id={} {}", 7, big);
+    assert(limited == "id=7 xxxxxxxxxxx [truncated 99989 bytes]");
+    assert(Logger::format_message(16, "short {}", 1) == "short 1");
+    // "é" is two bytes; the cut must not split it.
+    assert(truncate_message("aé", 2, 3) == "a [truncated 2 bytes]");
+    // format_to_n stops at the cap, so the character straddling it arrives half-written.
+    assert(Logger::format_message(2, "{}", "a\xc3\xa9z") == "a [truncated 3 bytes]");
+    assert(utf8_complete_length("ab\xe2\x82") == 2 && utf8_complete_length("ab\x80\x80") == 4);
+    for (const std::string wide : {"\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80"}) {
+        const std::string text = "ab" + wide + "z";
+        for (std::size_t cap = 3; cap < 2 + wide.size(); ++cap) {
+            const std::string expected = "ab [truncated " + std::to_string(text.size() - 2) + " bytes]";
+            assert(Logger::format_message(cap, "{}", text) == expected);
+            const auto deferred = DeferredRecord::capture(LogLevel::info, "t", LOG_SRC, "{}", text);
+            const Record rec = deferred.materialize("app", cap);
+            assert(rec.message == expected);
+            (void) JsonFormatter{}.format(rec);
+        }
+        assert(Logger::format_message(2 + wide.size(), "{}", text) == "ab" + wide + " [truncated 1 bytes]");
+    }
+
+    // Syslog chunking: pieces fit, rejoin to the input and never split a sequence.
+    using Chunks = std::vector<std::string_view>;
+    assert(split_utf8_chunks("abcdef", 4) == (Chunks{"abcd", "ef"}));
+    assert(split_utf8_chunks("abcdef", 0) == (Chunks{"abcdef"}));
+    assert(split_utf8_chunks("a\xc3\xa9" "b", 2) == (Chunks{"a", "\xc3\xa9", "b"}));
+    assert(split_utf8_chunks("\xe2\x82\xac\xe2\x82\xac", 4) == (Chunks{"\xe2\x82\xac", "\xe2\x82\xac"}));
+    // A sequence cut short by the end of the text stays in one piece.
+    assert(split_utf8_chunks("ab\xe2\x82", 3) == (Chunks{"ab", "\xe2\x82"}));
+    // A run of continuation bytes longer than a chunk is cut where it must be.
+    assert(split_utf8_chunks("\x80\x80\x80\x80\x80", 2) == (Chunks{"\x80\x80", "\x80\x80", "\x80"}));
+    const std::string mixed = "x\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\x80\xbfy";
+    for (std::size_t max = 1; max <= mixed.size(); ++max) {
+        std::string joined;
+        for (const auto chunk : split_utf8_chunks(mixed, max)) {
+            assert(!chunk.empty() && chunk.size() <= max);
+            joined += chunk;
+        }
+        assert(joined == mixed);
+    }
+
+    auto full = std::make_unique<CaptureSink>();
+    auto *full_lines = full.get();
+    auto capped = std::make_unique<CaptureSink>();
+    auto *capped_lines = capped.get();
+    std::vector<Logger::Target> targets;
+    targets.push_back(Logger::Target{std::move(full), std::make_unique<TextFormatter>()});
+    targets.push_back(Logger::Target{std::move(capped), std::make_unique<TextFormatter>()});
+    targets.back().max_record_bytes = 8;
+    Logger logger{std::move(targets), "app"};
+    logger.log(LogLevel::info, "t", LOG_SRC, "{}", big);
+    assert(full_lines->lines.size() == 1 && full_lines->lines[0].find(big) != std::string::npos);
+    assert(capped_lines->lines.size() == 1);
+    assert(capped_lines->lines[0].find("INFO: xxxxxxxx [truncated 99992 bytes]") != std::string::npos);
+
+    logger.set_max_message_bytes(4);
+    logger.log(LogLevel::info, "t", LOG_SRC, "{}", big);
+    assert(full_lines->lines.back().find("INFO: xxxx [truncated 99996 bytes]") != std::string::npos);
+}
+
 int main() {
     Logger::init(Config{"config.json"});
     TaggedLogger t("mod");
     t.info(LOG_SRC, "value {}", 123);
+    filter_tests();
+    failover_tests();
+    durable_file_tests();
+    file_writeback_tests();
+    direct_io_tests();
+    trace_sink_tests();
+    span_tests();
+    context_tests();
+    trace_context_tests();
+    backtrace_tests();
+    request_scope_tests();
+    sampling_tests();
+    lazy_tests();
+    metrics_tests();
+    profiler_tests();
+    control_tests();
+    overload_tests();
+    clock_tests();
+    sequence_tests();
+    static_logger_tests();
+    decorator_tests();
+    emergency_tests();
+    stdio_capture_tests();
+    large_message_tests();
     assert(true);
     return 0;
 }